@@ -2,7 +2,7 @@
 #include <Client/Setup.hh>
 
 int main() {
-    srand(std::time(0));
+    seed_rng(std::time(0));
     Game::init();
     main_loop();
     return 0;
@@ -4,6 +4,7 @@
 
 #include <Shared/Binary.hh>
 #include <Shared/Config.hh>
+#include <Shared/StringTable.hh>
 
 using namespace Game;
 
@@ -31,6 +32,19 @@ void Game::on_message(uint8_t *ptr, uint32_t len) {
                 curr_id = reader.read<EntityID>();
             }
             simulation.arena_info.read(&reader, reader.read<uint8_t>());
+            //strings for the handles above that are new to this client
+            StringID str = reader.read<StringID>();
+            while (!str.null()) {
+                StringTable::read(&reader, str);
+                str = reader.read<StringID>();
+            }
+            break;
+        }
+        case Clientbound::kHandshake: {
+            //comes before any update, so nothing is lost if the cap changes
+            uint32_t cap = reader.read<uint32_t>();
+            if (cap < MIN_ENTITY_CAP || cap > MAX_ENTITY_CAP) break;
+            simulation.reserve(cap);
             break;
         }
         default:
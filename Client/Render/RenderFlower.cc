@@ -17,7 +17,7 @@ void render_flower(Renderer &ctx, Entity const &ent) {
         .eye_y = ent.eye_y,
         .mouth = ent.mouth,
         .cutter_angle = (float) (Game::timestamp / 200),
-        .face_flags = ent.face_flags,
+        .face_flags = ent.face_flags(),
         .flags = static_cast<uint8_t>(((ent.deletion_animation > 0) ? 1 : 0) << 1),
         .color = ent.color
     });
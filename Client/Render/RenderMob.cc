@@ -23,7 +23,7 @@ void render_mob(Renderer &ctx, Entity const &ent) {
             .eye_y = ent.eye_y,
             .mouth = ent.mouth,
             .cutter_angle = (float) (Game::timestamp / 200),
-            .face_flags = ent.face_flags,
+            .face_flags = ent.face_flags(),
             .flags = static_cast<uint8_t>(1 | ((ent.deletion_animation > 0 ? 1 : 0) << 1)),
             .color = ent.color
         };
@@ -5,6 +5,7 @@
 #include <Client/Game.hh>
 
 #include <Shared/Entity.hh>
+#include <Shared/StringTable.hh>
 
 void render_name(Renderer &ctx, Entity const &ent) {
     if (!ent.nametag_visible) return;
@@ -12,5 +13,5 @@ void render_name(Renderer &ctx, Entity const &ent) {
     ctx.translate(0, -ent.radius - 18);
     ctx.set_global_alpha(1 - ent.deletion_animation);
     ctx.scale(1 + 0.5 * ent.deletion_animation);
-    ctx.draw_text(ent.name.c_str(), { .size = 18 });
+    ctx.draw_text(StringTable::get(ent.name), { .size = 18 });
 }
\ No newline at end of file
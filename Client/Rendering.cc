@@ -28,8 +28,8 @@ void Game::render_game() {
     DEBUG_ONLY(assert(simulation.ent_exists(camera_id));)
     Entity const &camera = simulation.get_ent(camera_id);
     renderer.translate(renderer.width / 2, renderer.height / 2);
-    renderer.scale(Ui::scale * camera.fov);
-    renderer.translate(-camera.camera_x, -camera.camera_y);
+    renderer.scale(Ui::scale * camera.fov());
+    renderer.translate(-camera.camera_x(), -camera.camera_y());
     if (alive()) {
         Entity const &player = simulation.get_ent(player_id);
         if (Game::timestamp - player.last_damaged_time < 150) {
@@ -42,7 +42,7 @@ void Game::render_game() {
             renderer.translate(rand.x, rand.y);
         }
     }
-    uint32_t alpha = (uint32_t)(camera.fov * 255 * 0.2) << 24;
+    uint32_t alpha = (uint32_t)(camera.fov() * 255 * 0.2) << 24;
     {
         RenderContext context(&renderer);
         renderer.reset_transform();
@@ -63,11 +63,11 @@ void Game::render_game() {
         }
         renderer.set_stroke(alpha);
         renderer.set_line_width(0.5);
-        float scale = 1 / (2 * camera.fov * Ui::scale);
-        float leftX = camera.camera_x - renderer.width * scale;
-        float rightX = camera.camera_x + renderer.width * scale;
-        float topY = camera.camera_y - renderer.height * scale;
-        float bottomY = camera.camera_y + renderer.height * scale;
+        float scale = 1 / (2 * camera.fov() * Ui::scale);
+        float leftX = camera.camera_x() - renderer.width * scale;
+        float rightX = camera.camera_x() + renderer.width * scale;
+        float topY = camera.camera_y() - renderer.height * scale;
+        float bottomY = camera.camera_y() + renderer.height * scale;
         float newLeftX = ceilf(leftX / 50) * 50;
         float newTopY = ceilf(topY / 50) * 50;
         renderer.begin_path();
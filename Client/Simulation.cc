@@ -37,10 +37,10 @@ void Simulation::tick() {
                 ent.deletion_animation = fclamp(ent.deletion_animation + Ui::dt / 125, 0, 1);
         }
         if (ent.has_component(kCamera)) {
-            ent.camera_x.step(amt);
-            ent.camera_y.step(amt);
-            ent.fov.step(amt);
-            Game::respawn_level = ent.respawn_level;
+            ent.camera_x().step(amt);
+            ent.camera_y().step(amt);
+            ent.fov().step(amt);
+            Game::respawn_level = ent.respawn_level();
         }
         if (ent.has_component(kHealth)) {
             ent.health_ratio.step(amt);
@@ -61,13 +61,13 @@ void Simulation::tick() {
                 LERP(ent.healthbar_lag, ent.health_ratio, amt / 3)
         }
         if (ent.has_component(kFlower)) {
-            LERP(ent.eye_x, cosf(ent.eye_angle) * 3, amt);
-            LERP(ent.eye_y, sinf(ent.eye_angle) * 3, amt);
-            if (BIT_AT(ent.face_flags, FaceFlags::kAttacking)
-                || BIT_AT(ent.face_flags, FaceFlags::kPoisoned) 
-                || BIT_AT(ent.face_flags, FaceFlags::kDandelioned)
+            LERP(ent.eye_x, cosf(ent.eye_angle()) * 3, amt);
+            LERP(ent.eye_y, sinf(ent.eye_angle()) * 3, amt);
+            if (BIT_AT(ent.face_flags(), FaceFlags::kAttacking)
+                || BIT_AT(ent.face_flags(), FaceFlags::kPoisoned) 
+                || BIT_AT(ent.face_flags(), FaceFlags::kDandelioned)
                 || ent.pending_delete) LERP(ent.mouth, 5, amt)
-            else if (BIT_AT(ent.face_flags, FaceFlags::kDefending)) LERP(ent.mouth, 8, amt)
+            else if (BIT_AT(ent.face_flags(), FaceFlags::kDefending)) LERP(ent.mouth, 8, amt)
             else LERP(ent.mouth, 15, amt)
         }
     });
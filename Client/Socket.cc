@@ -16,6 +16,8 @@ extern "C" {
             Writer w(INCOMING_PACKET);
             w.write<uint8_t>(Serverbound::kVerify);
             w.write<uint64_t>(VERSION_HASH);
+            w.write<uint8_t>(0);
+            w.write<uint32_t>(MAX_ENTITY_CAP);
             Game::reset();
             Game::socket.ready = 1; //force send
             Game::socket.send(w.packet, w.at - w.packet);
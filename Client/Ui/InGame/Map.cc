@@ -29,7 +29,7 @@ void Minimap::on_render(Renderer &ctx) {
         ctx.set_stroke(Renderer::HSV(0xffffe763, 0.8));
         ctx.set_line_width(ARENA_WIDTH / 120);
         ctx.begin_path();
-        ctx.arc(camera.camera_x, camera.camera_y, ARENA_WIDTH / 40);
+        ctx.arc(camera.camera_x(), camera.camera_y(), ARENA_WIDTH / 40);
         ctx.fill();
         ctx.stroke();
     }
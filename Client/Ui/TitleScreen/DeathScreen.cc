@@ -7,6 +7,8 @@
 #include <Client/Ui/StaticText.hh>
 #include <Client/Assets/Assets.hh>
 
+#include <Shared/StringTable.hh>
+
 using namespace Ui;
 
 class DeathFlower final : public Ui::Element {
@@ -87,9 +89,9 @@ Element *Ui::make_death_main_screen() {
         new Ui::DynamicText(22.5, [](){
             if (!Game::simulation.ent_exists(Game::camera_id))
                 return std::string{""};
-            if (Game::simulation.get_ent(Game::camera_id).killed_by == "") 
+            if (Game::simulation.get_ent(Game::camera_id).killed_by().null())
                 return std::string{"a mysterious entity"};
-            return Game::simulation.get_ent(Game::camera_id).killed_by;
+            return std::string{StringTable::get(Game::simulation.get_ent(Game::camera_id).killed_by())};
         }),
         new Ui::Element(0, 20),
         new DeathFlower(),
@@ -51,8 +51,8 @@ TitlePetalSlot::TitlePetalSlot(uint8_t p) : Element(50,50,{}), pos(p) {
         if (!Game::simulation.ent_exists(Game::camera_id))
             return false;
         Entity const &camera = Game::simulation.get_ent(Game::camera_id);
-        if (p >= loadout_slots_at_level(camera.respawn_level) + MAX_SLOT_COUNT) return false;
-        return camera.inventory[p] > PetalID::kBasic;
+        if (p >= loadout_slots_at_level(camera.respawn_level()) + MAX_SLOT_COUNT) return false;
+        return camera.inventory(p) > PetalID::kBasic;
     };
 }
 
@@ -60,7 +60,7 @@ void TitlePetalSlot::on_render(Renderer &ctx) {
     if (!Game::simulation.ent_exists(Game::camera_id))
         return;
     Entity const &camera = Game::simulation.get_ent(Game::camera_id);
-    uint8_t id = camera.inventory[pos];
+    uint8_t id = camera.inventory(pos);
     if (id == PetalID::kNone) return;
     ctx.scale(width / 60);
     draw_loadout_background(ctx, id);
@@ -70,7 +70,7 @@ void TitlePetalSlot::on_event(uint8_t event) {
     if (!Game::simulation.ent_exists(Game::camera_id))
         return;
     Entity const &camera = Game::simulation.get_ent(Game::camera_id);
-    uint8_t id = camera.inventory[pos];
+    uint8_t id = camera.inventory(pos);
     if (event != kFocusLost && id != PetalID::kNone) {
         rendering_tooltip = 1;
         tooltip = Ui::UiLoadout::petal_tooltips[id];
@@ -0,0 +1,413 @@
+#include <LoadGen/Connection.hh>
+
+#include <Shared/Arena.hh>
+#include <Shared/Binary.hh>
+#include <Shared/Config.hh>
+#include <Shared/StringTable.hh>
+
+#include <fcntl.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+
+LoadStats stats = {};
+int epoll_fd = -1;
+Rng script_rng;
+
+//what the real client's lerp_amount works out to at 60fps
+static float const LERP_AMOUNT = 0.2;
+//frames larger than this can only come from a desynced stream
+static uint64_t const MAX_FRAME_LEN = 1 << 24;
+
+//arena info is the same for everyone, no point keeping a copy per connection
+static Arena scratch_arena;
+static Entity scratch;
+
+static uint64_t _wall_us() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+Connection::Connection() : entity_cap(DEFAULT_ENTITY_CAP), fd(-1), state(ConnectionState::kClosed), index(0) {}
+
+void Connection::open(sockaddr_in const &addr, std::string const &request) {
+    fd = ::socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+        ++stats.connect_failures;
+        return;
+    }
+    int one = 1;
+    ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    if (::connect(fd, reinterpret_cast<sockaddr const *>(&addr), sizeof(addr)) < 0 && errno != EINPROGRESS) {
+        ::close(fd);
+        fd = -1;
+        ++stats.connect_failures;
+        return;
+    }
+    state = ConnectionState::kConnecting;
+    inbox.clear();
+    fragments.clear();
+    outbox.assign(request.begin(), request.end());
+    std::memset(known, 0, sizeof(known));
+    entity_cap = DEFAULT_ENTITY_CAP;
+    camera_id = NULL_ENTITY;
+    camera.init();
+    player.init();
+    heading = 0;
+    has_home = 0;
+    next_decision = 0;
+    next_spawn = 0;
+    want_write = 1;
+    epoll_event ev = {};
+    ev.events = EPOLLIN | EPOLLOUT;
+    ev.data.ptr = this;
+    ::epoll_ctl(epoll_fd, EPOLL_CTL_ADD, fd, &ev);
+}
+
+void Connection::close() {
+    if (state == ConnectionState::kClosed) return;
+    if (state == ConnectionState::kOpen) ++stats.disconnects;
+    else ++stats.connect_failures;
+    //closing the fd also drops it from the epoll set
+    ::close(fd);
+    fd = -1;
+    state = ConnectionState::kClosed;
+    inbox.clear();
+    outbox.clear();
+    fragments.clear();
+}
+
+uint8_t Connection::alive() const {
+    if (state != ConnectionState::kOpen || !camera.has_component(kCamera) || camera.player().null()) return 0;
+    return BIT_AT_ARR(known, camera.player().id) && hashes[camera.player().id] == camera.player().hash;
+}
+
+void Connection::_flush() {
+    while (outbox.size() > 0) {
+        ssize_t n = ::send(fd, outbox.data(), outbox.size(), MSG_NOSIGNAL);
+        if (n < 0) {
+            if (errno == EAGAIN || errno == EWOULDBLOCK) break;
+            close();
+            return;
+        }
+        outbox.erase(outbox.begin(), outbox.begin() + n);
+    }
+    uint8_t want = outbox.size() > 0;
+    if (want == want_write) return;
+    want_write = want;
+    epoll_event ev = {};
+    ev.events = EPOLLIN | (want ? EPOLLOUT : 0);
+    ev.data.ptr = this;
+    ::epoll_ctl(epoll_fd, EPOLL_CTL_MOD, fd, &ev);
+}
+
+void Connection::_send_frame(uint8_t opcode, uint8_t const *data, size_t len) {
+    uint8_t header[14];
+    size_t header_len = 2;
+    header[0] = 0x80 | opcode;
+    //client frames are always masked
+    if (len < 126)
+        header[1] = 0x80 | len;
+    else if (len < 65536) {
+        header[1] = 0x80 | 126;
+        header[2] = len >> 8;
+        header[3] = len;
+        header_len = 4;
+    } else {
+        header[1] = 0x80 | 127;
+        for (uint32_t i = 0; i < 8; ++i)
+            header[2 + i] = len >> (56 - 8 * i);
+        header_len = 10;
+    }
+    uint32_t mask = script_rng.next();
+    std::memcpy(header + header_len, &mask, 4);
+    uint8_t const *mask_bytes = header + header_len;
+    header_len += 4;
+    uint8_t was_empty = outbox.size() == 0;
+    outbox.insert(outbox.end(), header, header + header_len);
+    size_t start = outbox.size();
+    outbox.insert(outbox.end(), data, data + len);
+    for (size_t i = 0; i < len; ++i)
+        outbox[start + i] ^= mask_bytes[i & 3];
+    //anything already queued goes out on the next EPOLLOUT
+    if (was_empty) _flush();
+}
+
+void Connection::send(uint8_t const *data, size_t len) {
+    if (state != ConnectionState::kOpen) return;
+    stats.bytes_out += len;
+    _send_frame(0x2, data, len);
+}
+
+void Connection::on_writable() {
+    if (state == ConnectionState::kConnecting) {
+        int err = 0;
+        socklen_t len = sizeof(err);
+        ::getsockopt(fd, SOL_SOCKET, SO_ERROR, &err, &len);
+        if (err != 0) {
+            close();
+            return;
+        }
+        state = ConnectionState::kHandshake;
+    }
+    _flush();
+}
+
+void Connection::on_readable() {
+    uint8_t buf[1 << 16];
+    while (state != ConnectionState::kClosed) {
+        ssize_t n = ::recv(fd, buf, sizeof(buf), 0);
+        if (n == 0) {
+            close();
+            return;
+        }
+        if (n < 0) {
+            if (errno == EAGAIN || errno == EWOULDBLOCK) break;
+            close();
+            return;
+        }
+        inbox.insert(inbox.end(), buf, buf + n);
+    }
+    if (state == ConnectionState::kHandshake) {
+        static char const END[] = "\r\n\r\n";
+        auto iter = std::search(inbox.begin(), inbox.end(), END, END + 4);
+        if (iter == inbox.end()) {
+            if (inbox.size() > 8192) close();
+            return;
+        }
+        //the accept key isn't checked, the server is trusted
+        static char const OK[] = "HTTP/1.1 101";
+        if (inbox.size() < sizeof(OK) - 1 || std::memcmp(inbox.data(), OK, sizeof(OK) - 1) != 0) {
+            close();
+            return;
+        }
+        inbox.erase(inbox.begin(), iter + 4);
+        state = ConnectionState::kOpen;
+        ++stats.connects;
+        _on_handshake();
+    }
+    if (state == ConnectionState::kOpen) _on_frames();
+}
+
+void Connection::_on_handshake() {
+    uint8_t packet[64];
+    Writer writer(packet);
+    writer.write<uint8_t>(Serverbound::kVerify);
+    writer.write<uint64_t>(VERSION_HASH);
+    writer.write<uint8_t>(1 << VerifyFlags::kTickTimestamps);
+    writer.write<uint32_t>(MAX_ENTITY_CAP);
+    send(writer.packet, writer.at - writer.packet);
+}
+
+void Connection::_on_frames() {
+    size_t at = 0;
+    while (1) {
+        size_t avail = inbox.size() - at;
+        if (avail < 2) break;
+        uint8_t *frame = inbox.data() + at;
+        uint8_t fin = frame[0] >> 7;
+        uint8_t opcode = frame[0] & 15;
+        uint8_t masked = frame[1] >> 7;
+        uint64_t len = frame[1] & 127;
+        size_t header_len = 2;
+        if (len == 126) {
+            if (avail < 4) break;
+            len = (frame[2] << 8) | frame[3];
+            header_len = 4;
+        } else if (len == 127) {
+            if (avail < 10) break;
+            len = 0;
+            for (uint32_t i = 0; i < 8; ++i)
+                len = (len << 8) | frame[2 + i];
+            header_len = 10;
+        }
+        if (len > MAX_FRAME_LEN) {
+            ++stats.decode_errors;
+            close();
+            return;
+        }
+        uint8_t const *mask = frame + header_len;
+        if (masked) header_len += 4;
+        if (avail < header_len + len) break;
+        uint8_t *payload = frame + header_len;
+        if (masked)
+            for (uint64_t i = 0; i < len; ++i) payload[i] ^= mask[i & 3];
+        at += header_len + len;
+        if (opcode == 0x8) {
+            close();
+            return;
+        } else if (opcode == 0x9)
+            _send_frame(0xA, payload, len);
+        else if (opcode <= 0x2) {
+            if (fin && opcode != 0x0)
+                _on_message(payload, len);
+            else {
+                fragments.insert(fragments.end(), payload, payload + len);
+                if (fin) {
+                    _on_message(fragments.data(), fragments.size());
+                    fragments.clear();
+                }
+            }
+        }
+        if (state != ConnectionState::kOpen) return;
+    }
+    inbox.erase(inbox.begin(), inbox.begin() + at);
+}
+
+void Connection::_on_message(uint8_t const *data, size_t len) {
+    stats.bytes_in += len;
+    if (len == 0) {
+        ++stats.decode_errors;
+        return;
+    }
+    switch (data[0]) {
+        case Clientbound::kClientUpdate:
+            _on_update(data, len);
+            break;
+        case Clientbound::kOutdated: {
+            static uint8_t warned = 0;
+            if (!warned) std::cout << "server is running a different version\n";
+            warned = 1;
+            close();
+            break;
+        }
+        case Clientbound::kDisconnect:
+            close();
+            break;
+        case Clientbound::kHandshake: {
+            Reader reader(data + 1);
+            entity_cap = reader.read<uint32_t>();
+            if (entity_cap < MIN_ENTITY_CAP || entity_cap > MAX_ENTITY_CAP) {
+                ++stats.decode_errors;
+                close();
+            }
+            break;
+        }
+        default:
+            ++stats.decode_errors;
+            break;
+    }
+}
+
+void Connection::_forget(EntityID id) {
+    BIT_UNSET_ARR(known, id.id);
+}
+
+//mirrors Game::on_message on the real client, but only the camera and the player keep their state
+void Connection::_on_update(uint8_t const *data, size_t len) {
+    uint64_t now = _wall_us();
+    uint8_t const *end = data + len;
+    Reader reader(data + 1);
+    ++stats.updates;
+    camera_id = reader.read<EntityID>();
+    EntityID curr_id = reader.read<EntityID>();
+    while (!curr_id.null()) {
+        if (curr_id.id >= entity_cap || !BIT_AT_ARR(known, curr_id.id) || hashes[curr_id.id] != curr_id.hash) {
+            ++stats.decode_errors;
+            return;
+        }
+        _forget(curr_id);
+        curr_id = reader.read<EntityID>();
+    }
+    curr_id = reader.read<EntityID>();
+    while (!curr_id.null()) {
+        if (curr_id.id >= entity_cap || reader.at >= end) {
+            ++stats.decode_errors;
+            return;
+        }
+        uint8_t create = reader.read<uint8_t>();
+        uint8_t is_known = BIT_AT_ARR(known, curr_id.id) && hashes[curr_id.id] == curr_id.hash;
+        if (BIT_AT(create, 0)) {
+            if (is_known) ++stats.decode_errors;
+            BIT_SET_ARR(known, curr_id.id);
+            hashes[curr_id.id] = curr_id.hash;
+        } else if (!is_known) {
+            ++stats.decode_errors;
+            return;
+        }
+        Entity *ent = &scratch;
+        if (curr_id == camera_id) ent = &camera;
+        else if (camera.has_component(kCamera) && curr_id == camera.player()) ent = &player;
+        if (BIT_AT(create, 0)) ent->init();
+        //scratch stands in for every entity whose state isn't kept, so an update may carry any component's fields
+        else if (ent == &scratch)
+            for (uint32_t i = 0; i < kComponentCount; ++i)
+                if (!scratch.has_component(i)) scratch.add_component(i);
+        ent->id = curr_id;
+        ent->read(&reader, BIT_AT(create, 0));
+        if (ent == &player && BIT_AT(create, 0)) {
+            home_x = player.x.get_target();
+            home_y = player.y.get_target();
+            has_home = 1;
+        }
+        if (reader.at > end) {
+            ++stats.decode_errors;
+            return;
+        }
+        curr_id = reader.read<EntityID>();
+    }
+    scratch_arena.read(&reader, reader.read<uint8_t>());
+    StringID str = reader.read<StringID>();
+    while (!str.null()) {
+        if (reader.at >= end) {
+            ++stats.decode_errors;
+            return;
+        }
+        StringTable::read(&reader, str);
+        str = reader.read<StringID>();
+    }
+    if (reader.at < end) {
+        uint64_t tick_start = reader.read<uint64_t>();
+        stats.latency_us.push_back(now > tick_start ? now - tick_start : 0);
+    }
+    if (reader.at != end) ++stats.decode_errors;
+}
+
+void Connection::drive(uint64_t now_ms) {
+    if (state != ConnectionState::kOpen) return;
+    if (!alive()) {
+        if (now_ms < next_spawn) return;
+        next_spawn = now_ms + 1000;
+        uint8_t packet[64];
+        Writer writer(packet);
+        writer.write<uint8_t>(Serverbound::kClientSpawn);
+        writer.write<std::string>("loadgen" + std::to_string(index));
+        send(writer.packet, writer.at - writer.packet);
+        return;
+    }
+    player.x.step(LERP_AMOUNT);
+    player.y.step(LERP_AMOUNT);
+    if (now_ms >= next_decision) {
+        next_decision = now_ms + 1000 + script_rng.next() % 2000;
+        heading = script_rng.next_double() * 2 * M_PI;
+    }
+    float x = std::cos(heading) * 200;
+    float y = std::sin(heading) * 200;
+    //wander, but don't drift out of the starting zone
+    if (has_home) {
+        float dx = home_x - player.x;
+        float dy = home_y - player.y;
+        if (dx * dx + dy * dy > 1500 * 1500) {
+            x = dx;
+            y = dy;
+        }
+    }
+    uint8_t input = 0;
+    //attack for half of every 4 seconds
+    if ((now_ms + index * 250) % 4000 < 2000) BIT_SET(input, InputFlags::kAttacking);
+    uint8_t packet[64];
+    Writer writer(packet);
+    writer.write<uint8_t>(Serverbound::kClientInput);
+    writer.write<float>(x);
+    writer.write<float>(y);
+    writer.write<uint8_t>(input);
+    send(writer.packet, writer.at - writer.packet);
+}
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <Shared/Entity.hh>
+#include <Shared/Simulation.hh>
+
+#include <netinet/in.h>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace ConnectionState {
+    enum : uint8_t {
+        kClosed,
+        kConnecting,
+        kHandshake,
+        kOpen
+    };
+};
+
+//counters for the current report interval, reset by Main.cc
+struct LoadStats {
+    uint64_t connects;
+    uint64_t disconnects;
+    uint64_t bytes_in;
+    uint64_t bytes_out;
+    uint64_t connect_failures;
+    uint64_t updates;
+    uint64_t decode_errors;
+    //tick start on the server to the update being decoded here, in microseconds
+    std::vector<uint32_t> latency_us;
+};
+
+extern LoadStats stats;
+extern int epoll_fd;
+//drives headings and frame masks, seeded once in Main.cc
+extern Rng script_rng;
+
+class Connection {
+    std::vector<uint8_t> inbox;
+    std::vector<uint8_t> outbox;
+    std::vector<uint8_t> fragments;
+    //entities the server told us about, to catch updates and deletes that don't line up
+    //sized for any cap, ids past the one the server sent are decode errors
+    uint8_t known[div_round_up(MAX_ENTITY_CAP, 8)];
+    EntityID::hash_type hashes[MAX_ENTITY_CAP];
+    uint32_t entity_cap;
+    EntityID camera_id;
+    Entity camera;
+    Entity player;
+    float heading;
+    float home_x;
+    float home_y;
+    uint8_t has_home;
+    uint64_t next_decision;
+    uint64_t next_spawn;
+    uint8_t want_write;
+
+    void _send_frame(uint8_t, uint8_t const *, size_t);
+    void _flush();
+    void _on_handshake();
+    void _on_frames();
+    void _on_message(uint8_t const *, size_t);
+    void _on_update(uint8_t const *, size_t);
+    void _forget(EntityID);
+public:
+    int fd;
+    uint8_t state;
+    uint32_t index;
+    Connection();
+    //starts a nonblocking connect, the handshake request is sent once it completes
+    void open(sockaddr_in const &, std::string const &);
+    void close();
+    void on_writable();
+    void on_readable();
+    //called at 60hz while open, sends input and respawns
+    void drive(uint64_t);
+    void send(uint8_t const *, size_t);
+    uint8_t alive() const;
+};
@@ -0,0 +1,160 @@
+#include <LoadGen/Connection.hh>
+
+#include <Shared/Config.hh>
+
+#include <netdb.h>
+#include <sys/epoll.h>
+#include <sys/resource.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <string>
+#include <vector>
+
+//usage: gardn-loadgen [host] [port] [connections] [seconds] [--seed n] [--ramp n]
+//opens many connections to a running server, plays each one with scripted input at 60hz and decodes
+//every update, printing throughput, tick-to-receive latency and decode errors once a second
+//plain ws:// only, point it at a NO_SSL or io_uring build
+
+static uint32_t const FRAME_US = 1000000 / 60;
+
+static uint64_t _now_us() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static uint32_t _percentile(std::vector<uint32_t> const &sorted, uint32_t pct) {
+    if (sorted.size() == 0) return 0;
+    return sorted[std::min<size_t>(sorted.size() - 1, sorted.size() * pct / 100)];
+}
+
+static void _report(char const *label, LoadStats &interval, double seconds, uint32_t open, uint32_t alive, uint32_t total) {
+    std::sort(interval.latency_us.begin(), interval.latency_us.end());
+    std::printf("%-6s open %u/%u alive %u  in %.1f KB/s  out %.1f KB/s  %.0f updates/s  ", label, open, total, alive,
+        interval.bytes_in / 1024.0 / seconds, interval.bytes_out / 1024.0 / seconds, interval.updates / seconds);
+    if (interval.latency_us.size() > 0)
+        std::printf("latency p50 %.2fms p99 %.2fms max %.2fms  ", _percentile(interval.latency_us, 50) / 1e3,
+            _percentile(interval.latency_us, 99) / 1e3, interval.latency_us.back() / 1e3);
+    else
+        std::printf("latency n/a  ");
+    std::printf("decode errors %llu  disconnects %llu  failed %llu\n", (unsigned long long) interval.decode_errors,
+        (unsigned long long) interval.disconnects, (unsigned long long) interval.connect_failures);
+    std::fflush(stdout);
+}
+
+static void _accumulate(LoadStats &totals, LoadStats const &interval) {
+    totals.connects += interval.connects;
+    totals.disconnects += interval.disconnects;
+    totals.bytes_in += interval.bytes_in;
+    totals.bytes_out += interval.bytes_out;
+    totals.connect_failures += interval.connect_failures;
+    totals.updates += interval.updates;
+    totals.decode_errors += interval.decode_errors;
+    totals.latency_us.insert(totals.latency_us.end(), interval.latency_us.begin(), interval.latency_us.end());
+}
+
+int main(int argc, char **argv) {
+    std::vector<char const *> args;
+    uint64_t seed = std::time(0);
+    uint32_t ramp = 50;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--seed") == 0 && i + 1 < argc) seed = std::strtoull(argv[++i], nullptr, 10);
+        else if (std::strcmp(argv[i], "--ramp") == 0 && i + 1 < argc) ramp = std::max(1, std::atoi(argv[++i]));
+        else args.push_back(argv[i]);
+    }
+    char const *host = args.size() > 0 ? args[0] : "127.0.0.1";
+    std::string port = args.size() > 1 ? args[1] : std::to_string(SERVER_PORT);
+    uint32_t count = args.size() > 2 ? std::atoi(args[2]) : 100;
+    uint32_t seconds = args.size() > 3 ? std::atoi(args[3]) : 60;
+    script_rng.seed(seed);
+
+    addrinfo hints = {};
+    hints.ai_family = AF_INET;
+    hints.ai_socktype = SOCK_STREAM;
+    addrinfo *res = nullptr;
+    if (getaddrinfo(host, port.c_str(), &hints, &res) != 0 || res == nullptr) {
+        std::printf("could not resolve %s\n", host);
+        return 1;
+    }
+    sockaddr_in addr;
+    std::memcpy(&addr, res->ai_addr, sizeof(addr));
+    freeaddrinfo(res);
+
+    //every connection is a socket, lift the soft limit as far as it goes
+    rlimit limit;
+    if (getrlimit(RLIMIT_NOFILE, &limit) == 0) {
+        limit.rlim_cur = limit.rlim_max;
+        setrlimit(RLIMIT_NOFILE, &limit);
+        if (limit.rlim_cur < count + 16)
+            std::printf("warning: fd limit %llu is below %u connections\n", (unsigned long long) limit.rlim_cur, count);
+    }
+
+    //the server doesn't check the key beyond its presence, so every connection shares one
+    std::string request = std::string("GET / HTTP/1.1\r\nHost: ") + host + ":" + port +
+        "\r\nUpgrade: websocket\r\nConnection: Upgrade\r\nSec-WebSocket-Key: dGhlIHNhbXBsZSBub25jZQ==\r\n"
+        "Sec-WebSocket-Version: 13\r\n\r\n";
+
+    epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    std::vector<Connection> connections(count);
+    for (uint32_t i = 0; i < count; ++i) connections[i].index = i;
+    std::printf("%u connections to %s:%s for %us, version %llu, seed %llu\n", count, host, port.c_str(), seconds,
+        (unsigned long long) VERSION_HASH, (unsigned long long) seed);
+
+    LoadStats totals = {};
+    uint64_t start = _now_us();
+    uint64_t end = start + seconds * 1000000ull;
+    uint64_t next_frame = start;
+    uint64_t next_report = start + 1000000;
+    uint64_t last_report = start;
+    uint32_t opened = 0;
+    epoll_event events[1024];
+    for (uint64_t now = start; now < end; now = _now_us()) {
+        for (uint32_t i = 0; i < ramp && opened < count; ++i)
+            connections[opened++].open(addr, request);
+        int timeout = next_frame > now ? (next_frame - now + 999) / 1000 : 0;
+        int n = epoll_wait(epoll_fd, events, 1024, timeout);
+        for (int i = 0; i < n; ++i) {
+            Connection *conn = static_cast<Connection *>(events[i].data.ptr);
+            uint32_t ev = events[i].events;
+            if (ev & (EPOLLOUT | EPOLLERR | EPOLLHUP)) conn->on_writable();
+            if ((ev & (EPOLLIN | EPOLLERR | EPOLLHUP)) && conn->state >= ConnectionState::kHandshake)
+                conn->on_readable();
+        }
+        now = _now_us();
+        if (now >= next_frame) {
+            for (Connection &conn : connections) conn.drive(now / 1000);
+            next_frame += FRAME_US;
+            //fell behind, don't burst to catch up
+            if (next_frame < now) next_frame = now + FRAME_US;
+        }
+        if (now >= next_report) {
+            uint32_t open = 0;
+            uint32_t alive = 0;
+            for (Connection const &conn : connections) {
+                open += conn.state == ConnectionState::kOpen;
+                alive += conn.alive();
+            }
+            char label[16];
+            std::snprintf(label, sizeof(label), "%llus", (unsigned long long) ((now - start) / 1000000));
+            _report(label, stats, (now - last_report) / 1e6, open, alive, count);
+            _accumulate(totals, stats);
+            stats = {};
+            last_report = now;
+            next_report += 1000000;
+        }
+    }
+    _accumulate(totals, stats);
+    uint32_t open = 0;
+    uint32_t alive = 0;
+    for (Connection &conn : connections) {
+        open += conn.state == ConnectionState::kOpen;
+        alive += conn.alive();
+        conn.close();
+    }
+    _report("total", totals, (_now_us() - start) / 1e6, open, alive, count);
+    return totals.decode_errors > 0;
+}
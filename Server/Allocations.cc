@@ -0,0 +1,103 @@
+#include <Server/Allocations.hh>
+
+#ifdef ALLOC_COUNTING
+#include <Server/Server.hh>
+
+#include <Shared/Entity.hh>
+
+#include <cassert>
+#include <cstdlib>
+#include <new>
+
+thread_local uint64_t Allocations::total = 0;
+thread_local uint64_t Allocations::counted = 0;
+uint64_t Allocations::last_tick = 0;
+uint64_t Allocations::ticks_allocating = 0;
+
+static thread_local uint8_t counting = 0;
+static uint32_t pool_capacity = 0;
+
+//the chunked component pools allocate whenever they outgrow their high water mark, which is expected,
+//and so does the simulation when it commits more slots and sets up the entities in them
+static uint32_t _pool_capacity() {
+    uint32_t capacity = Server::game.simulation.committed_slots();
+    #ifndef INLINE_COMPONENTS
+    #define COMPONENT(name) capacity += name##_chunks.capacity();
+    PER_CHUNKED_COMPONENT
+    #undef COMPONENT
+    #endif
+    return capacity;
+}
+
+void Allocations::begin_tick() {
+    counted = 0;
+    pool_capacity = _pool_capacity();
+    counting = 1;
+}
+
+void Allocations::end_tick() {
+    counting = 0;
+    last_tick = counted;
+    if (counted == 0) return;
+    ++ticks_allocating;
+    assert(_pool_capacity() != pool_capacity);
+}
+
+Allocations::Uncounted::Uncounted() : was_counting(counting) {
+    counting = 0;
+}
+
+Allocations::Uncounted::~Uncounted() {
+    counting = was_counting;
+}
+
+//every unaligned form is replaced, not only the ones the others forward to, so a sanitizer's
+//own versions can't end up freeing what these allocated
+static void *_allocate(std::size_t size) {
+    ++Allocations::total;
+    Allocations::counted += counting;
+    return std::malloc(size == 0 ? 1 : size);
+}
+
+void *operator new(std::size_t size) {
+    void *ptr = _allocate(size);
+    if (ptr == nullptr) throw std::bad_alloc();
+    return ptr;
+}
+
+void *operator new[](std::size_t size) {
+    return operator new(size);
+}
+
+void *operator new(std::size_t size, std::nothrow_t const &) noexcept {
+    return _allocate(size);
+}
+
+void *operator new[](std::size_t size, std::nothrow_t const &) noexcept {
+    return _allocate(size);
+}
+
+void operator delete(void *ptr) noexcept {
+    std::free(ptr);
+}
+
+void operator delete[](void *ptr) noexcept {
+    std::free(ptr);
+}
+
+void operator delete(void *ptr, std::size_t) noexcept {
+    std::free(ptr);
+}
+
+void operator delete[](void *ptr, std::size_t) noexcept {
+    std::free(ptr);
+}
+
+void operator delete(void *ptr, std::nothrow_t const &) noexcept {
+    std::free(ptr);
+}
+
+void operator delete[](void *ptr, std::nothrow_t const &) noexcept {
+    std::free(ptr);
+}
+#endif
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <cstdint>
+
+#if defined(DEBUG) || defined(BENCHMARK)
+#define ALLOC_COUNTING
+#define ALLOC_COUNTING_ONLY(...) __VA_ARGS__
+#else
+#define ALLOC_COUNTING_ONLY(...)
+#endif
+
+#ifdef ALLOC_COUNTING
+//counts calls to the global operator new, compiled into debug and benchmark builds
+//once the game is warm a tick should not allocate at all, end_tick asserts it
+namespace Allocations {
+    //everything allocated on this thread
+    extern thread_local uint64_t total;
+    //allocated on this thread between begin_tick and end_tick, outside of Uncounted scopes
+    extern thread_local uint64_t counted;
+    //what the last tick allocated
+    extern uint64_t last_tick;
+    extern uint64_t ticks_allocating;
+    void begin_tick();
+    void end_tick();
+
+    //for work that allocates on purpose and isn't part of the simulation, like handing packets to the socket
+    class Uncounted {
+        uint8_t was_counting;
+    public:
+        Uncounted();
+        ~Uncounted();
+    };
+};
+#endif
@@ -0,0 +1,533 @@
+#include <Server/Process.hh>
+#include <Server/Spawn.hh>
+#include <Server/SpatialHash.hh>
+
+#include <Shared/Binary.hh>
+#include <Shared/Config.hh>
+#include <Shared/Entity.hh>
+#include <Shared/Simulation.hh>
+#include <Shared/StaticData.hh>
+#include <Shared/StringTable.hh>
+
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+//usage: gardn-microbench [filter]
+//times the protocol codec, packet validation, entity serialization, spawning and the spatial hash in isolation
+//prints one json object per line so runs can be diffed and tracked over time
+//the spatial hash variant is fixed at link time, gardn-microbench-canonical covers the other one
+//and gardn-microbench-inline the entity layout from before chunked components
+
+#ifdef CANONICAL_SPATIAL_HASH
+static char const *VARIANT = "canonical";
+#else
+static char const *VARIANT = "uniform";
+#endif
+
+#ifdef INLINE_COMPONENTS
+static char const *LAYOUT = "inline";
+#else
+static char const *LAYOUT = "chunked";
+#endif
+
+static const uint32_t REPEATS = 15;
+static const uint32_t CODEC_VALUES = 1 << 16;
+
+static char const *filter = nullptr;
+static Rng rng(1);
+static volatile uint64_t sink = 0;
+static Simulation simulation;
+static uint8_t buffer[CODEC_VALUES * 16];
+
+namespace CacheCounter {
+    enum : uint8_t {
+        kL1d,
+        kLlc,
+        kNumCounters
+    };
+};
+
+//-1 where perf counters aren't available (containers, perf_event_paranoid), the misses are left out
+static int counters[CacheCounter::kNumCounters] = { -1, -1 };
+
+static void _open_counters() {
+    uint64_t const configs[CacheCounter::kNumCounters] = {
+        PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16),
+        PERF_COUNT_HW_CACHE_LL | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16)
+    };
+    for (uint32_t i = 0; i < CacheCounter::kNumCounters; ++i) {
+        perf_event_attr attr = {};
+        attr.size = sizeof(attr);
+        attr.type = PERF_TYPE_HW_CACHE;
+        attr.config = configs[i];
+        attr.disabled = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        counters[i] = syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+    }
+}
+
+static double _now() {
+    return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+//fn runs ops operations per call, reports min and median ns/op over REPEATS calls
+//returns the median, 0 if the filter left it out
+template<typename F>
+static double _bench(char const *group, char const *name, char const *params, uint32_t ops, F const &fn) {
+    std::string full = std::string(group) + "." + name;
+    if (filter != nullptr && full.find(filter) == std::string::npos) return 0;
+    if (ops == 0) ops = 1;
+    fn();
+    std::vector<double> samples;
+    for (int fd : counters) {
+        if (fd < 0) continue;
+        ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+        ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+    }
+    for (uint32_t i = 0; i < REPEATS; ++i) {
+        double start = _now();
+        fn();
+        samples.push_back((_now() - start) / ops);
+    }
+    std::string misses;
+    static char const *COUNTER_NAMES[CacheCounter::kNumCounters] = { "l1d", "llc" };
+    for (uint32_t i = 0; i < CacheCounter::kNumCounters; ++i) {
+        if (counters[i] < 0) continue;
+        ioctl(counters[i], PERF_EVENT_IOC_DISABLE, 0);
+        uint64_t count = 0;
+        if (read(counters[i], &count, sizeof(count)) != sizeof(count)) continue;
+        char field[64];
+        std::snprintf(field, sizeof(field), ",\"%s_misses_per_op\":%.3f", COUNTER_NAMES[i], (double) count / REPEATS / ops);
+        misses += field;
+    }
+    std::sort(samples.begin(), samples.end());
+    std::printf("{\"bench\":\"%s\",\"variant\":\"%s\",\"layout\":\"%s\",%s%s\"ops\":%u,\"ns_per_op_min\":%.3f,\"ns_per_op_median\":%.3f%s}\n",
+        full.c_str(), VARIANT, LAYOUT, params, params[0] ? "," : "", ops, samples[0], samples[REPEATS / 2], misses.c_str());
+    std::fflush(stdout);
+    return samples[REPEATS / 2];
+}
+
+//spreads values over every encoded length so the varint loops are not perfectly predicted
+static uint64_t _varied(uint32_t bits) {
+    uint64_t v = rng.next();
+    if (bits < 64) v &= (1ull << bits) - 1;
+    return v >> (rng.next() % bits);
+}
+
+template<typename T>
+static void _codec(char const *name, std::vector<T> const &values) {
+    _bench("binary.write", name, "", values.size(), [&](){
+        Writer writer(buffer);
+        for (T const &v : values) writer.write<T>(v);
+        sink = sink + writer.at - writer.packet;
+    });
+    Writer writer(buffer);
+    for (T const &v : values) writer.write<T>(v);
+    char params[64];
+    std::snprintf(params, sizeof(params), "\"bytes_per_value\":%.3f", (double) (writer.at - writer.packet) / values.size());
+    _bench("binary.read", name, params, values.size(), [&](){
+        Reader reader(buffer);
+        T v;
+        for (uint32_t i = 0; i < values.size(); ++i) reader.read<T>(v);
+        sink = sink + reader.at - reader.packet;
+    });
+}
+
+template<typename T>
+static std::vector<T> _values(uint32_t bits, uint8_t is_signed) {
+    std::vector<T> ret(CODEC_VALUES);
+    for (T &v : ret) {
+        v = (T) _varied(bits);
+        if (is_signed && rng.next() % 2) v = -v;
+    }
+    return ret;
+}
+
+static void _bench_codec() {
+    _codec<uint8_t>("uint8", _values<uint8_t>(8, 0));
+    _codec<uint16_t>("uint16", _values<uint16_t>(16, 0));
+    _codec<uint32_t>("uint32", _values<uint32_t>(32, 0));
+    _codec<uint64_t>("uint64", _values<uint64_t>(64, 0));
+    _codec<int32_t>("int32", _values<int32_t>(31, 1));
+    _codec<int64_t>("int64", _values<int64_t>(63, 1));
+
+    //positions and small deltas, which is what floats carry in practice
+    std::vector<float> floats(CODEC_VALUES);
+    for (uint32_t i = 0; i < CODEC_VALUES; ++i)
+        floats[i] = i % 2 ? frand() * ARENA_WIDTH : (frand() - 0.5) * 20;
+    _codec<float>("float", floats);
+
+    std::vector<EntityID> ids(CODEC_VALUES);
+    for (EntityID &id : ids)
+        id = EntityID(rng.next() % DEFAULT_ENTITY_CAP, rng.next());
+    _codec<EntityID>("entity_id", ids);
+
+    std::vector<std::string> names(CODEC_VALUES / 16);
+    for (std::string &name : names)
+        for (uint32_t i = rng.next() % (MAX_NAME_LENGTH + 1); i > 0; --i)
+            name.push_back('a' + rng.next() % 26);
+    _codec<std::string>("string", names);
+}
+
+//each packet type is checked field by field in the same order Client::on_message does
+namespace PacketKind {
+    enum : uint8_t {
+        kVerify,
+        kInput,
+        kSpawn,
+        kPetalSwap,
+        kPetalDelete,
+        kNumKinds
+    };
+};
+
+static char const *PACKET_NAMES[PacketKind::kNumKinds] = { "verify", "input", "spawn", "petal_swap", "petal_delete" };
+
+static uint8_t _validate(uint8_t kind, uint8_t const *start, uint8_t const *end) {
+    Validator validator(start, end);
+    if (!validator.validate_uint8()) return 0;
+    switch (kind) {
+        case PacketKind::kVerify:
+            return validator.validate_uint64();
+        case PacketKind::kInput:
+            return validator.validate_float() && validator.validate_float() && validator.validate_uint8();
+        case PacketKind::kSpawn:
+            return validator.validate_string(MAX_NAME_LENGTH);
+        case PacketKind::kPetalSwap:
+            return validator.validate_uint8() && validator.validate_uint8();
+        case PacketKind::kPetalDelete:
+            return validator.validate_uint8();
+    }
+    return 0;
+}
+
+static void _bench_validator() {
+    static const uint32_t PACKETS = 4096;
+    static uint8_t packets[PacketKind::kNumKinds][PACKETS][64];
+    static uint32_t lengths[PacketKind::kNumKinds][PACKETS];
+    for (uint32_t i = 0; i < PACKETS; ++i) {
+        Writer verify(packets[PacketKind::kVerify][i]);
+        verify.write<uint8_t>(Serverbound::kVerify);
+        verify.write<uint64_t>(VERSION_HASH);
+        lengths[PacketKind::kVerify][i] = verify.at - verify.packet;
+
+        Writer input(packets[PacketKind::kInput][i]);
+        input.write<uint8_t>(Serverbound::kClientInput);
+        input.write<float>((frand() - 0.5) * 400);
+        input.write<float>((frand() - 0.5) * 400);
+        input.write<uint8_t>(rng.next() % 4);
+        lengths[PacketKind::kInput][i] = input.at - input.packet;
+
+        Writer spawn(packets[PacketKind::kSpawn][i]);
+        spawn.write<uint8_t>(Serverbound::kClientSpawn);
+        std::string name;
+        for (uint32_t n = rng.next() % (MAX_NAME_LENGTH + 1); n > 0; --n)
+            name.push_back('a' + rng.next() % 26);
+        spawn.write<std::string>(name);
+        lengths[PacketKind::kSpawn][i] = spawn.at - spawn.packet;
+
+        Writer swap(packets[PacketKind::kPetalSwap][i]);
+        swap.write<uint8_t>(Serverbound::kPetalSwap);
+        swap.write<uint8_t>(rng.next() % (2 * MAX_SLOT_COUNT));
+        swap.write<uint8_t>(rng.next() % (2 * MAX_SLOT_COUNT));
+        lengths[PacketKind::kPetalSwap][i] = swap.at - swap.packet;
+
+        Writer del(packets[PacketKind::kPetalDelete][i]);
+        del.write<uint8_t>(Serverbound::kPetalDelete);
+        del.write<uint8_t>(rng.next() % (2 * MAX_SLOT_COUNT));
+        lengths[PacketKind::kPetalDelete][i] = del.at - del.packet;
+    }
+    for (uint8_t kind = 0; kind < PacketKind::kNumKinds; ++kind) {
+        _bench("validator", PACKET_NAMES[kind], "", PACKETS, [&](){
+            for (uint32_t i = 0; i < PACKETS; ++i)
+                sink = sink + _validate(kind, packets[kind][i], packets[kind][i] + lengths[kind][i]);
+        });
+        //truncated packets take the early-out paths
+        char name[64];
+        std::snprintf(name, sizeof(name), "%s_truncated", PACKET_NAMES[kind]);
+        _bench("validator", name, "", PACKETS, [&](){
+            for (uint32_t i = 0; i < PACKETS; ++i)
+                sink = sink + _validate(kind, packets[kind][i], packets[kind][i] + lengths[kind][i] - 1);
+        });
+    }
+}
+
+static void _bench_entity(char const *name, Entity &ent) {
+    static const uint32_t WRITES = 4096;
+    Writer writer(buffer);
+    ent.write<true>(&writer);
+    char params[64];
+    std::snprintf(params, sizeof(params), "\"bytes\":%u", (uint32_t) (writer.at - writer.packet));
+    _bench("entity.write_create", name, params, WRITES, [&](){
+        Writer writer(buffer);
+        for (uint32_t i = 0; i < WRITES; ++i) {
+            writer.at = writer.packet;
+            ent.write<true>(&writer);
+        }
+        sink = sink + writer.at - writer.packet;
+    });
+
+    //a typical moving entity: only position and angle changed since the last tick
+    ent.reset_protocol();
+    ent.set_x(ent.x() + 1);
+    ent.set_y(ent.y() + 1);
+    ent.set_angle(ent.angle() + 0.1);
+    writer.at = writer.packet;
+    ent.write<false>(&writer);
+    std::snprintf(params, sizeof(params), "\"bytes\":%u", (uint32_t) (writer.at - writer.packet));
+    _bench("entity.write_update", name, params, WRITES, [&](){
+        Writer writer(buffer);
+        for (uint32_t i = 0; i < WRITES; ++i) {
+            writer.at = writer.packet;
+            ent.write<false>(&writer);
+        }
+        sink = sink + writer.at - writer.packet;
+    });
+
+    ent.reset_protocol();
+    writer.at = writer.packet;
+    ent.write<false>(&writer);
+    std::snprintf(params, sizeof(params), "\"bytes\":%u", (uint32_t) (writer.at - writer.packet));
+    _bench("entity.write_idle", name, params, WRITES, [&](){
+        Writer writer(buffer);
+        for (uint32_t i = 0; i < WRITES; ++i) {
+            writer.at = writer.packet;
+            ent.write<false>(&writer);
+        }
+        sink = sink + writer.at - writer.packet;
+    });
+}
+
+static void _bench_entities() {
+    simulation.reset();
+    Entity &mob = alloc_mob(&simulation, MobID::kBabyAnt, 1000, 1000, NULL_ENTITY);
+    Entity &flower = alloc_player(&simulation, NULL_ENTITY);
+    flower.set_x(1200);
+    flower.set_y(1000);
+    flower.set_name(StringTable::intern("benchmark"));
+    Entity &petal = alloc_petal(&simulation, PetalID::kBasic, flower);
+    _bench_entity("mob", mob);
+    _bench_entity("petal", petal);
+    _bench_entity("flower", flower);
+}
+
+//an entity spawned and its slot freed again, the churn of zone spawns, petal reloads and drops
+//spawns_per_us comes from the medians
+static void _bench_spawns() {
+    static const uint32_t SPAWNS = 1024;
+    simulation.reset();
+    Entity &flower = alloc_player(&simulation, NULL_ENTITY);
+    std::vector<EntityID> ids;
+    ids.reserve(SPAWNS);
+    auto free_all = [&]() {
+        for (EntityID const &id : ids) {
+            simulation.budget.untrack(simulation.get_ent(id));
+            simulation._delete_ent(id);
+        }
+        ids.clear();
+    };
+    double mob = _bench("spawn", "mob", "", SPAWNS, [&](){
+        for (uint32_t i = 0; i < SPAWNS; ++i)
+            ids.push_back(alloc_mob(&simulation, MobID::kBabyAnt, frand() * ARENA_WIDTH, frand() * ARENA_HEIGHT, NULL_ENTITY).id);
+        free_all();
+    });
+    double petal = _bench("spawn", "petal", "", SPAWNS, [&](){
+        for (uint32_t i = 0; i < SPAWNS; ++i)
+            ids.push_back(alloc_petal(&simulation, PetalID::kBasic, flower).id);
+        free_all();
+    });
+    double drop = _bench("spawn", "drop", "", SPAWNS, [&](){
+        for (uint32_t i = 0; i < SPAWNS; ++i)
+            ids.push_back(alloc_drop(&simulation, PetalID::kBasic).id);
+        free_all();
+    });
+    if (mob == 0 || petal == 0 || drop == 0) return;
+    std::printf("{\"bench\":\"spawn.rate\",\"layout\":\"%s\",\"mob_spawns_per_us\":%.3f,\"petal_spawns_per_us\":%.3f,\"drop_spawns_per_us\":%.3f}\n",
+        LAYOUT, 1000 / mob, 1000 / petal, 1000 / drop);
+    std::fflush(stdout);
+}
+
+//a crowded arena: players with their camera and a full loadout of petals, mobs filling the rest
+//players join between mobs, so their entities are spread through the id space as in a real game
+static void _bench_sweeps() {
+    static const uint32_t PLAYERS = 96;
+    static const uint32_t PETALS = 8;
+    std::string full = "entity.sizeof";
+    if (filter == nullptr || full.find(filter) != std::string::npos) {
+        std::printf("{\"bench\":\"%s\",\"layout\":\"%s\",\"entity\":%zu,\"simulation\":%zu,\"camera_data\":%zu,\"flower_data\":%zu}\n",
+            full.c_str(), LAYOUT, sizeof(Entity), sizeof(Simulation), sizeof(CameraData), sizeof(FlowerData));
+    }
+    simulation.reset();
+    std::vector<EntityID> all;
+    std::vector<EntityID> cameras;
+    std::vector<EntityID> flowers;
+    uint32_t const target = simulation.entity_cap() - 256;
+    uint32_t const stride = target / PLAYERS;
+    for (uint32_t i = 0; all.size() < target; ++i) {
+        if (i % stride == 0 && cameras.size() < PLAYERS) {
+            Entity &camera = simulation.alloc_ent();
+            camera.add_component(kCamera);
+            camera.add_component(kRelations);
+            camera.set_camera_x(frand() * ARENA_WIDTH);
+            camera.set_camera_y(frand() * ARENA_HEIGHT);
+            camera.set_fov(BASE_FOV);
+            Entity &flower = alloc_player(&simulation, camera.id);
+            flower.set_x(camera.camera_x());
+            flower.set_y(camera.camera_y());
+            camera.set_player(flower.id);
+            flower.set_loadout_count(PETALS);
+            all.push_back(camera.id);
+            all.push_back(flower.id);
+            cameras.push_back(camera.id);
+            flowers.push_back(flower.id);
+            for (uint32_t j = 0; j < PETALS; ++j) {
+                flower.set_loadout_ids(j, PetalID::kBasic);
+                all.push_back(alloc_petal(&simulation, PetalID::kBasic, flower).id);
+            }
+            continue;
+        }
+        all.push_back(alloc_mob(&simulation, MobID::kBabyAnt, frand() * ARENA_WIDTH, frand() * ARENA_HEIGHT, NULL_ENTITY).id);
+    }
+    char params[96];
+    std::snprintf(params, sizeof(params), "\"entity_bytes\":%zu,\"entities\":%zu", sizeof(Entity), all.size());
+
+    //what motion and collision read of every entity
+    _bench("entity.sweep", "physics", params, all.size(), [&](){
+        float n = 0;
+        for (EntityID const &id : all) {
+            Entity const &ent = simulation.get_ent(id);
+            if (!ent.has_component(kPhysics)) continue;
+            n += ent.x() + ent.y() + ent.radius() + ent.velocity().x + ent.acceleration().y + ent.friction();
+        }
+        sink = sink + (uint64_t) n;
+    });
+
+    //the same fields read the way the sweeps do, straight from the packed arrays
+    _bench("entity.sweep", "physics_packed", params, all.size(), [&](){
+        EntityHotArrays const &hot = simulation.hot;
+        float n = 0;
+        for (EntityID const &id : all) {
+            if (!BIT_AT(hot.components[id.id], kPhysics)) continue;
+            n += hot.x[id.id] + hot.y[id.id] + hot.radius[id.id] + hot.velocity[id.id].x + hot.acceleration[id.id].y + hot.friction[id.id];
+        }
+        sink = sink + (uint64_t) n;
+    });
+
+    //what the player systems read, only a handful of entities but scattered over the whole array
+    _bench("entity.sweep", "players", params, cameras.size(), [&](){
+        float n = 0;
+        for (uint32_t i = 0; i < cameras.size(); ++i) {
+            Entity const &camera = simulation.get_ent(cameras[i]);
+            Entity const &flower = simulation.get_ent(flowers[i]);
+            n += camera.camera_x() + camera.camera_y() + camera.fov() + camera.respawn_level();
+            for (uint32_t j = 0; j < flower.loadout_count(); ++j)
+                n += flower.loadout(j).already_spawned + flower.loadout_ids(j);
+        }
+        sink = sink + (uint64_t) n;
+    });
+
+    //the motion kernel over every physics entity, all of them accelerating so every lane moves
+    simulation.pre_tick();
+    for (EntityID const &id : all) {
+        Entity &ent = simulation.get_ent(id);
+        if (!ent.has_component(kPhysics)) continue;
+        ent.acceleration() = Vector::rand(2);
+        ent.friction() = 0.25;
+    }
+    _bench("entity.sweep", "motion", params, all.size(), [&](){
+        tick_entity_motion(&simulation);
+    });
+
+    _bench("entity.sweep", "write_create", params, all.size(), [&](){
+        uint64_t n = 0;
+        for (EntityID const &id : all) {
+            Writer writer(buffer);
+            simulation.get_ent(id).write<true>(&writer);
+            n += writer.at - writer.packet;
+        }
+        sink = sink + n;
+    });
+}
+
+//entities are scattered over a square of the arena at a given number of entities per grid cell
+static void _bench_spatial_hash(float per_cell) {
+    static const uint32_t SIDE = 4000;
+    static const uint32_t QUERIES = 256;
+    uint32_t count = std::min<uint32_t>(simulation.entity_cap() - 1, per_cell * (SIDE / GRID_SIZE) * (SIDE / GRID_SIZE));
+    simulation.reset();
+    std::vector<EntityID> ids;
+    for (uint32_t i = 0; i < count; ++i) {
+        Entity &ent = simulation.alloc_ent();
+        ent.add_component(kPhysics);
+        ent.set_x(frand() * SIDE);
+        ent.set_y(frand() * SIDE);
+        //mob and petal sized, within the uniform grid's limit
+        ent.set_radius(10 + frand() * (GRID_SIZE / 2 - 10));
+        ids.push_back(ent.id);
+    }
+    SpatialHash &hash = simulation.spatial_hash;
+    char params[96];
+    std::snprintf(params, sizeof(params), "\"per_cell\":%g,\"entities\":%u", per_cell, count);
+
+    //includes clearing the grid, as the server rebuilds it every tick
+    _bench("spatial_hash.insert", "rebuild", params, count, [&](){
+        hash.refresh(ARENA_WIDTH, ARENA_HEIGHT);
+        for (EntityID const &id : ids)
+            hash.insert(id);
+        hash.sort();
+    });
+
+    uint64_t pairs = 0;
+    hash.collide([&](Simulation *, EntityID const &, EntityID const &){ ++pairs; });
+    _bench("spatial_hash.collide", "pairs", params, pairs, [&](){
+        uint64_t n = 0;
+        hash.collide([&](Simulation *, EntityID const &a, EntityID const &b){ n += a.id ^ b.id; });
+        sink = sink + n;
+    });
+
+    std::vector<std::pair<float, float>> centers(QUERIES);
+    for (auto &c : centers)
+        c = { frand() * SIDE, frand() * SIDE };
+    //a camera's view, and the much smaller find_nearest_enemy radius
+    float const shapes[2][2] = { { 960 + 50, 540 + 50 }, { 300, 300 } };
+    char const *names[2] = { "camera", "detection" };
+    for (uint32_t s = 0; s < 2; ++s) {
+        uint64_t results = 0;
+        for (auto &c : centers)
+            hash.query(c.first, c.second, shapes[s][0], shapes[s][1], [&](Simulation *, Entity &){ ++results; });
+        char query_params[160];
+        std::snprintf(query_params, sizeof(query_params), "%s,\"results_per_query\":%.1f", params, (double) results / QUERIES);
+        _bench("spatial_hash.query", names[s], query_params, QUERIES, [&](){
+            uint64_t n = 0;
+            for (auto &c : centers)
+                hash.query(c.first, c.second, shapes[s][0], shapes[s][1], [&](Simulation *, Entity &ent){ n += ent.id.id; });
+            sink = sink + n;
+        });
+    }
+}
+
+int main(int argc, char **argv) {
+    if (argc > 1) filter = argv[1];
+    seed_rng(1);
+    _open_counters();
+    _bench_codec();
+    _bench_validator();
+    _bench_entities();
+    _bench_spawns();
+    _bench_sweeps();
+    for (float per_cell : { 0.25f, 1.0f, 4.0f, 16.0f })
+        _bench_spatial_hash(per_cell);
+    return 0;
+}
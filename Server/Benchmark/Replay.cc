@@ -0,0 +1,139 @@
+#include <Server/Client.hh>
+#include <Server/Game.hh>
+#include <Server/Profiler.hh>
+#include <Server/Recorder.hh>
+#include <Server/Server.hh>
+#include <Server/StateHash.hh>
+
+#include <Shared/Binary.hh>
+#include <Shared/Config.hh>
+#include <Shared/StaticData.hh>
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <unordered_map>
+#include <vector>
+
+//usage: gardn-replay <log> [--hashes <out>] [--dump <tick> <out>]
+//re-runs a session written with gardn-server --record as fast as possible, then prints the profile
+//the log only replays faithfully on a build with the same game logic and flags
+//--hashes writes "<tick> <state hash>" for every tick, --dump writes every field's hash at the start
+//of one tick and stops there (see compare-builds.sh)
+
+int main(int argc, char **argv) {
+    if (argc < 2) {
+        std::cout << "usage: gardn-replay <log> [--hashes <out>] [--dump <tick> <out>]\n";
+        return 1;
+    }
+    std::FILE *hashes = nullptr;
+    std::FILE *dump = nullptr;
+    uint64_t dump_tick = 0;
+    for (int i = 2; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--hashes") == 0 && i + 1 < argc)
+            hashes = std::fopen(argv[++i], "w");
+        else if (std::strcmp(argv[i], "--dump") == 0 && i + 2 < argc) {
+            dump_tick = std::strtoull(argv[++i], nullptr, 10);
+            dump = std::fopen(argv[++i], "w");
+        }
+    }
+    if (hashes != nullptr || dump != nullptr) StateHash::enabled = 1;
+    std::FILE *file = std::fopen(argv[1], "rb");
+    if (file == nullptr) {
+        std::cout << "could not open " << argv[1] << '\n';
+        return 1;
+    }
+    std::vector<uint8_t> log;
+    uint8_t chunk[1 << 16];
+    for (size_t n; (n = std::fread(chunk, 1, sizeof(chunk), file)) > 0; )
+        log.insert(log.end(), chunk, chunk + n);
+    std::fclose(file);
+    size_t size = log.size();
+    //the validator peeks one byte past a truncated varint
+    log.resize(size + 16);
+
+    uint8_t const *end = log.data() + size;
+    Reader reader(log.data());
+    if (size < sizeof(Recorder::MAGIC) || std::memcmp(log.data(), Recorder::MAGIC, sizeof(Recorder::MAGIC)) != 0) {
+        std::cout << argv[1] << " is not a session log\n";
+        return 1;
+    }
+    reader.at += sizeof(Recorder::MAGIC);
+    Validator validator(reader.at, end);
+    if (!validator.validate_uint64() || !validator.validate_uint64()) {
+        std::cout << "truncated header\n";
+        return 1;
+    }
+    uint64_t version = reader.read<uint64_t>();
+    if (version != VERSION_HASH)
+        std::cout << "warning: recorded on version " << version << ", this build is " << VERSION_HASH << '\n';
+    Server::seed = reader.read<uint64_t>();
+    //the cap has to be known before the game starts
+    if (reader.at < end && *reader.at == RecordKind::kEntityCap) {
+        reader.read<uint8_t>();
+        if (!validator.validate_uint8() || !validator.validate_uint32()) {
+            std::cout << "truncated header\n";
+            return 1;
+        }
+        Server::entity_cap = reader.read<uint32_t>();
+        if (Server::entity_cap < MIN_ENTITY_CAP || Server::entity_cap > MAX_ENTITY_CAP) {
+            std::cout << "bad entity cap " << Server::entity_cap << '\n';
+            return 1;
+        }
+    }
+    seed_rng(Server::seed);
+    Server::game.init();
+
+    std::unordered_map<uint32_t, WebSocket *> sockets;
+    uint64_t ticks = 0;
+    uint64_t messages = 0;
+    uint32_t connects = 0;
+    uint8_t done = 0;
+    uint64_t start = Profiler::now();
+    //a log cut off mid-record (the server was killed) replays up to the last whole record
+    while (!done && validator.validate_uint8() && validator.validate_uint32()) {
+        uint8_t kind = reader.read<uint8_t>();
+        uint32_t value = reader.read<uint32_t>();
+        if (kind == RecordKind::kTicks) {
+            for (uint32_t i = 0; i < value && !done; ++i) {
+                if (dump != nullptr && ticks == dump_tick) StateHash::dump_to = dump;
+                Server::tick();
+                if (hashes != nullptr)
+                    std::fprintf(hashes, "%llu %016llx\n", (unsigned long long) ticks, (unsigned long long) StateHash::last);
+                done = dump != nullptr && ticks == dump_tick;
+                ++ticks;
+            }
+        } else if (kind == RecordKind::kConnect) {
+            sockets[value] = new WebSocket(value);
+            ++connects;
+        } else if (kind == RecordKind::kMessage) {
+            if (!validator.validate_string(MAX_PACKET_LEN)) break;
+            uint32_t len = reader.read<uint32_t>();
+            std::string_view message(reinterpret_cast<char const *>(reader.at), len);
+            reader.at += len;
+            auto iter = sockets.find(value);
+            if (iter == sockets.end()) continue;
+            Client::on_message(iter->second, message, 0);
+            ++messages;
+        } else if (kind == RecordKind::kDisconnect) {
+            auto iter = sockets.find(value);
+            if (iter == sockets.end()) continue;
+            Client::on_disconnect(iter->second, 1000, {});
+            delete iter->second;
+            sockets.erase(iter);
+        } else {
+            std::cout << "corrupt record at offset " << (reader.at - log.data()) << '\n';
+            break;
+        }
+    }
+    double seconds = (Profiler::now() - start) / 1e9;
+    if (hashes != nullptr) std::fclose(hashes);
+    if (dump != nullptr) std::fclose(dump);
+    char line[160];
+    std::snprintf(line, sizeof(line), "replayed %llu ticks (%.1f min of play) with %u clients and %llu messages in %.2fs, %.0f ticks/s\n",
+        (unsigned long long) ticks, ticks / (60.0 * TPS), connects, (unsigned long long) messages, seconds, ticks / seconds);
+    std::cout << line;
+    Profiler::dump(std::cout);
+    return 0;
+}
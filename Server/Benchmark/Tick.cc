@@ -0,0 +1,220 @@
+#include <Server/Allocations.hh>
+#include <Server/Client.hh>
+#include <Server/Game.hh>
+#include <Server/HotCounters.hh>
+#include <Server/PetalTracker.hh>
+#include <Server/Server.hh>
+#include <Server/Profiler.hh>
+#include <Server/TickArena.hh>
+
+#include <Shared/Binary.hh>
+#include <Shared/Config.hh>
+#include <Shared/Entity.hh>
+#include <Shared/Simulation.hh>
+#include <Shared/StaticData.hh>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+//usage: gardn-bench [bots] [ticks] [seed]
+//runs the game in-process with scripted bots and reports per-system tick times
+//update_client is summed over all clients in a tick
+
+namespace BotScript {
+    enum : uint8_t {
+        kWander,
+        kAttack,
+        kDefend,
+        kNumScripts
+    };
+};
+
+static char const *SCRIPT_NAMES[BotScript::kNumScripts] = { "wander", "attack", "defend" };
+
+//bots get their own stream so scripting them never shifts the game's
+static Rng bot_rng;
+
+struct Bot {
+    WebSocket *ws;
+    uint8_t script;
+    float heading;
+    EntityID target;
+    uint32_t next_decision;
+};
+
+static void _send(Bot &bot, Writer &writer) {
+    std::string_view message(reinterpret_cast<char const *>(writer.packet), writer.at - writer.packet);
+    Client::on_message(bot.ws, message, 0);
+}
+
+static void _join(Bot &bot) {
+    static uint8_t buf[64];
+    Writer writer(buf);
+    writer.write<uint8_t>(Serverbound::kVerify);
+    writer.write<uint64_t>(VERSION_HASH);
+    _send(bot, writer);
+
+    //varied loadouts, swap out the starting basics before the first spawn
+    Client *client = bot.ws->getUserData();
+    Simulation *sim = &Server::game.simulation;
+    Entity &camera = sim->get_ent(client->camera);
+    camera.set_respawn_level(1 + bot_rng.next() % 45);
+    for (uint32_t i = 0; i < 2 * MAX_SLOT_COUNT; ++i) {
+        if (camera.inventory(i) != PetalID::kNone)
+            PetalTracker::remove_petal(sim, camera.inventory(i));
+        camera.set_inventory(i, PetalID::kNone);
+    }
+    for (uint32_t i = 0; i < loadout_slots_at_level(camera.respawn_level()); ++i) {
+        PetalID::T id = PetalID::kBasic + bot_rng.next() % (PetalID::kNumPetals - PetalID::kBasic);
+        camera.set_inventory(i, id);
+        PetalTracker::add_petal(sim, id);
+    }
+}
+
+static void _spawn(Bot &bot) {
+    static uint8_t buf[64];
+    Writer writer(buf);
+    writer.write<uint8_t>(Serverbound::kClientSpawn);
+    writer.write<std::string>("bot");
+    _send(bot, writer);
+}
+
+static EntityID _nearest_mob(Simulation *sim, Entity const &player, float range) {
+    EntityID best = NULL_ENTITY;
+    float best_dist = range * range;
+    sim->for_each<kMob>([&](Simulation *sim, Entity &ent) {
+        if (!sim->ent_alive(ent.id)) return;
+        float dx = ent.x() - player.x();
+        float dy = ent.y() - player.y();
+        float dist = dx * dx + dy * dy;
+        if (dist >= best_dist) return;
+        best_dist = dist;
+        best = ent.id;
+    });
+    return best;
+}
+
+static void _drive(Bot &bot, uint32_t tick) {
+    Client *client = bot.ws->getUserData();
+    if (client->game == nullptr) return;
+    if (!client->alive()) {
+        _spawn(bot);
+        return;
+    }
+    Simulation *sim = &client->game->simulation;
+    Entity &player = sim->get_ent(sim->get_ent(client->camera).player());
+    if (tick >= bot.next_decision) {
+        bot.next_decision = tick + TPS + bot_rng.next() % (2 * TPS);
+        bot.heading = bot_rng.next_double() * 2 * M_PI;
+        if (bot.script != BotScript::kWander)
+            bot.target = _nearest_mob(sim, player, 1000);
+    }
+    float x = std::cos(bot.heading) * 200;
+    float y = std::sin(bot.heading) * 200;
+    uint8_t input = 0;
+    if (bot.script != BotScript::kWander && sim->ent_alive(bot.target)) {
+        Entity const &target = sim->get_ent(bot.target);
+        float dx = target.x() - player.x();
+        float dy = target.y() - player.y();
+        //attackers close in, defenders keep their distance
+        if (bot.script == BotScript::kDefend) {
+            dx = -dx;
+            dy = -dy;
+        }
+        x = dx;
+        y = dy;
+    }
+    if (bot.script == BotScript::kAttack)
+        BIT_SET(input, InputFlags::kAttacking);
+    if (bot.script == BotScript::kDefend)
+        BIT_SET(input, InputFlags::kDefending);
+    static uint8_t buf[64];
+    Writer writer(buf);
+    writer.write<uint8_t>(Serverbound::kClientInput);
+    writer.write<float>(x);
+    writer.write<float>(y);
+    writer.write<uint8_t>(input);
+    _send(bot, writer);
+}
+
+static void _report(char const *name, std::vector<double> &samples) {
+    std::sort(samples.begin(), samples.end());
+    double sum = 0;
+    for (double s : samples) sum += s;
+    uint32_t n = samples.size();
+    std::printf("%-14s %9.4f %9.4f %9.4f %9.4f\n", name, sum / n,
+        samples[n / 2], samples[std::min<uint32_t>(n - 1, n * 99 / 100)], samples[n - 1]);
+}
+
+int main(int argc, char **argv) {
+    uint32_t bot_count = argc > 1 ? std::atoi(argv[1]) : 100;
+    uint32_t tick_count = argc > 2 ? std::atoi(argv[2]) : 60 * TPS;
+    uint32_t seed = argc > 3 ? std::atoi(argv[3]) : 1;
+    if (tick_count == 0) tick_count = 1;
+    Server::seed = seed;
+    seed_rng(seed);
+    bot_rng.seed(seed, 2);
+    Server::game.init();
+
+    std::vector<Bot> bots(bot_count);
+    uint32_t script_counts[BotScript::kNumScripts] = {0};
+    for (uint32_t i = 0; i < bot_count; ++i) {
+        Bot &bot = bots[i];
+        bot.ws = new WebSocket(i);
+        bot.script = i % BotScript::kNumScripts;
+        bot.heading = 0;
+        bot.target = NULL_ENTITY;
+        bot.next_decision = 0;
+        ++script_counts[bot.script];
+        _join(bot);
+        _spawn(bot);
+    }
+    std::printf("%u bots (", bot_count);
+    for (uint32_t i = 0; i < BotScript::kNumScripts; ++i)
+        std::printf("%s%u %s", i ? ", " : "", script_counts[i], SCRIPT_NAMES[i]);
+    std::printf("), %u ticks, seed %u\n", tick_count, seed);
+
+    std::vector<double> samples[ProfileSection::kNumSections];
+    std::vector<double> bytes_per_client;
+    std::vector<double> allocations;
+    for (uint32_t tick = 0; tick < tick_count; ++tick) {
+        for (Bot &bot : bots)
+            _drive(bot, tick);
+        Server::tick();
+        for (uint32_t i = 0; i < ProfileSection::kNumSections; ++i)
+            samples[i].push_back(Profiler::tick_ns[i] / 1e6);
+        if (Server::net_stats.packets_sent > 0)
+            bytes_per_client.push_back((double) Server::net_stats.bytes_sent / Server::net_stats.packets_sent);
+        allocations.push_back(Allocations::last_tick);
+    }
+
+    std::printf("%-14s %9s %9s %9s %9s\n", "system (ms)", "mean", "p50", "p99", "max");
+    for (uint32_t i = 0; i < ProfileSection::kNumSections; ++i)
+        _report(Profiler::NAMES[i], samples[i]);
+    if (bytes_per_client.size() > 0) {
+        std::printf("%-14s %9s %9s %9s %9s\n", "bytes/client", "mean", "p50", "p99", "max");
+        _report("update", bytes_per_client);
+    }
+    //only component pools growing may allocate inside a tick
+    std::printf("%-14s %9s %9s %9s %9s\n", "heap/tick", "mean", "p50", "p99", "max");
+    _report("allocations", allocations);
+    std::printf("%-14s %9zu\n", "arena peak", TickArena::peak());
+    #ifdef HOT_COUNTERS
+    HotCounterSet const &hot = HotCounters::totals;
+    std::printf("%-14s %9s\n", "per tick", "mean");
+    std::printf("%-14s %9.1f\n", "candidates", (double) hot.candidate_pairs / tick_count);
+    std::printf("%-14s %9.1f\n", "aabb pass", (double) hot.aabb_pairs / tick_count);
+    std::printf("%-14s %9.1f\n", "interact", (double) hot.interact_pairs / tick_count);
+    std::printf("%-14s %9.1f\n", "contacts", (double) hot.contacts / tick_count);
+    static char const *CALLERS[QueryCaller::kNumCallers] = { "other", "culling", "nearest_enemy", "update_client" };
+    std::printf("%-14s %9s %9s %9s\n", "queries", "calls", "cells", "results");
+    for (uint32_t i = 0; i < QueryCaller::kNumCallers; ++i)
+        std::printf("%-14s %9.1f %9.1f %9.1f\n", CALLERS[i], (double) hot.query_calls[i] / tick_count,
+            (double) hot.query_cells[i] / tick_count, (double) hot.query_results[i] / tick_count);
+    #endif
+    return 0;
+}
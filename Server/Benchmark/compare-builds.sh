@@ -0,0 +1,30 @@
+#!/bin/sh
+#usage: compare-builds.sh <gardn-replay a> <gardn-replay b> <log>
+#replays one session log on two builds and reports the first tick whose state differs,
+#then the entities and fields that differ at the start of that tick
+set -e
+if [ $# -ne 3 ]; then
+    echo "usage: $0 <gardn-replay a> <gardn-replay b> <log>"
+    exit 2
+fi
+out=$(mktemp -d)
+trap 'rm -rf "$out"' EXIT
+
+"$1" "$3" --hashes "$out/a" > /dev/null
+"$2" "$3" --hashes "$out/b" > /dev/null
+
+tick=$(paste -d ' ' "$out/a" "$out/b" | awk '$2 != $4 { print $1; exit }')
+if [ -z "$tick" ]; then
+    if [ "$(wc -l < "$out/a")" -ne "$(wc -l < "$out/b")" ]; then
+        echo "builds agree on every common tick but replayed a different number of ticks"
+        exit 1
+    fi
+    echo "builds agree on all $(wc -l < "$out/a") ticks"
+    exit 0
+fi
+
+"$1" "$3" --dump "$tick" "$out/dump-a" > /dev/null
+"$2" "$3" --dump "$tick" "$out/dump-b" > /dev/null
+echo "first divergence at the start of tick $tick (lines are <entity id> <field> <value hash>):"
+diff "$out/dump-a" "$out/dump-b" | head -n 40
+exit 1
@@ -0,0 +1,66 @@
+#!/bin/sh
+#usage: compare-transports.sh <gardn-server a> <gardn-server b> <gardn-loadgen> [connections] [seconds]
+#runs the same load against two servers one after the other, eg. a NO_SSL uWS build and an io_uring build,
+#and reports the load generator's latency next to the server's socket writes, the syscalls that made
+#them and its cpu time, all per second of load
+#both servers bind the game port and the metrics port, so nothing else may be listening on them
+#the load generator only speaks ws://, PORT_A and PORT_B (default 2053) point it at a relay instead, eg.
+#socat TCP-LISTEN:2054,reuseaddr,fork OPENSSL:127.0.0.1:2053,verify=0 in front of a TLS build
+set -e
+if [ $# -lt 3 ] || [ $# -gt 5 ]; then
+    echo "usage: $0 <gardn-server a> <gardn-server b> <gardn-loadgen> [connections] [seconds]"
+    exit 2
+fi
+connections=${4:-100}
+seconds=${5:-30}
+metrics=http://127.0.0.1:9101/metrics
+hz=$(getconf CLK_TCK)
+out=$(mktemp -d)
+trap 'rm -rf "$out"' EXIT
+
+#utime and stime in clock ticks, counted after the command name since it may hold spaces
+cpu() {
+    sed 's/.*) //' "/proc/$1/stat" | cut -d ' ' -f 12,13
+}
+
+sample() {
+    awk -v name="$1" '$1 == name { print $2 }' "$2"
+}
+
+run() {
+    "$1" > "$out/server" 2>&1 &
+    pid=$!
+    tries=0
+    until curl -sf "$metrics" > "$out/before"; do
+        tries=$((tries + 1))
+        if [ $tries -gt 50 ] || ! kill -0 $pid 2> /dev/null; then
+            echo "$1 did not start serving metrics:"
+            cat "$out/server"
+            exit 1
+        fi
+        sleep 0.1
+    done
+    cpu_before=$(cpu $pid)
+    status=0
+    "$3" 127.0.0.1 "$4" "$connections" "$seconds" > "$out/loadgen" || status=$?
+    cpu_after=$(cpu $pid)
+    curl -sf "$metrics" > "$out/after"
+    kill $pid
+    wait $pid 2> /dev/null || true
+
+    echo "$2: $1"
+    tail -n 1 "$out/loadgen"
+    if [ $status -ne 0 ]; then echo "  load generator exited with $status"; fi
+    for name in gardn_socket_writes_total gardn_transport_syscalls_total; do
+        printf '%s %s\n' "$(sample $name "$out/before")" "$(sample $name "$out/after")"
+    done | awk -v secs="$seconds" -v before="$cpu_before" -v after="$cpu_after" -v hz="$hz" '
+        { rate[NR] = ($2 - $1) / secs }
+        END {
+            split(before, b, " "); split(after, a, " ")
+            printf "  %.0f socket writes/s  %.0f syscalls/s  cpu user %.1f%%  sys %.1f%%\n", rate[1], rate[2],
+                100 * (a[1] - b[1]) / hz / secs, 100 * (a[2] - b[2]) / hz / secs
+        }'
+}
+
+run "$1" a "$3" "${PORT_A:-2053}"
+run "$2" b "$3" "${PORT_B:-2053}"
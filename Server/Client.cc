@@ -2,11 +2,14 @@
 
 #include <Server/Game.hh>
 #include <Server/PetalTracker.hh>
+#include <Server/Profiler.hh>
+#include <Server/Recorder.hh>
 #include <Server/Server.hh>
 #include <Server/Spawn.hh>
 
 #include <Shared/Binary.hh>
 #include <Shared/Config.hh>
+#include <Shared/StringTable.hh>
 
 #include <iostream>
 
@@ -34,7 +37,7 @@ uint8_t Client::alive() {
     if (game == nullptr) return false;
     Simulation *simulation = &game->simulation;
     return simulation->ent_exists(camera) 
-    && simulation->ent_exists(simulation->get_ent(camera).player);
+    && simulation->ent_exists(simulation->get_ent(camera).player());
 }
 
 #define VALIDATE(expr) if (!expr) { client->disconnect(); return; }
@@ -49,6 +52,8 @@ void Client::on_message(WebSocket *ws, std::string_view message, uint64_t code)
         ws->end();
         return;
     }
+    Recorder::on_message(client, message);
+    PROFILE_SCOPE_ARG(kMessage, client->verified ? client->camera.id : 0);
     if (!client->verified) {
         VALIDATE(validator.validate_uint8());
         if (reader.read<uint8_t>() != Serverbound::kVerify) {
@@ -64,6 +69,30 @@ void Client::on_message(WebSocket *ws, std::string_view message, uint64_t code)
             client->disconnect();
             return;
         }
+        if (validator.validate_uint8())
+            client->tick_timestamps = BIT_AT(reader.read<uint8_t>(), VerifyFlags::kTickTimestamps);
+        //clients from before the cap was negotiated were built for the default
+        uint32_t client_cap = DEFAULT_ENTITY_CAP;
+        if (validator.validate_uint32())
+            client_cap = reader.read<uint32_t>();
+        if (client_cap < Server::entity_cap) {
+            Writer writer(Server::OUTGOING_PACKET);
+            writer.write<uint8_t>(Clientbound::kOutdated);
+            client->send_packet(writer.packet, writer.at - writer.packet);
+            client->disconnect();
+            return;
+        }
+        //every client holds a camera for as long as it is connected
+        if (!Server::game.simulation.budget.can_spawn(BudgetCategory::kPlayerOwned, 1)) {
+            client->disconnect();
+            return;
+        }
+        {
+            Writer writer(Server::OUTGOING_PACKET);
+            writer.write<uint8_t>(Clientbound::kHandshake);
+            writer.write<uint32_t>(Server::entity_cap);
+            client->send_packet(writer.packet, writer.at - writer.packet);
+        }
         client->verified = 1;
         client->init();
         return;
@@ -72,6 +101,7 @@ void Client::on_message(WebSocket *ws, std::string_view message, uint64_t code)
         client->disconnect();
         return;
     }
+    RngScope rng(client->game->simulation.rng);
     VALIDATE(validator.validate_uint8());
     switch (reader.read<uint8_t>()) {
         case Serverbound::kVerify:
@@ -81,19 +111,19 @@ void Client::on_message(WebSocket *ws, std::string_view message, uint64_t code)
             if (!client->alive()) break;
             Simulation *simulation = &client->game->simulation;
             Entity &camera = simulation->get_ent(client->camera);
-            Entity &player = simulation->get_ent(camera.player);
+            Entity &player = simulation->get_ent(camera.player());
             VALIDATE(validator.validate_float());
             VALIDATE(validator.validate_float());
             float x = reader.read<float>();
             float y = reader.read<float>();
-            if (x == 0 && y == 0) player.acceleration.set(0,0);
+            if (x == 0 && y == 0) player.acceleration().set(0,0);
             else {
                 if (std::abs(x) > 5e3 || std::abs(y) > 5e3) break;
                 Vector accel(x,y);
                 float m = accel.magnitude();
                 if (m > 200) accel.set_magnitude(PLAYER_ACCELERATION);
                 else accel.set_magnitude(m / 200 * PLAYER_ACCELERATION);
-                player.acceleration = accel;
+                player.acceleration() = accel;
             }
             VALIDATE(validator.validate_uint8());
             player.input = reader.read<uint8_t>();
@@ -103,8 +133,10 @@ void Client::on_message(WebSocket *ws, std::string_view message, uint64_t code)
         case Serverbound::kClientSpawn: {
             if (client->alive()) break;
             Simulation *simulation = &client->game->simulation;
+            //the client asks again, by then eviction will have made room
+            if (!simulation->budget.can_spawn(BudgetCategory::kPlayerOwned, 1)) break;
             Entity &camera = simulation->get_ent(client->camera);
-            Entity &player = alloc_player(simulation, camera.team);
+            Entity &player = alloc_player(simulation, camera.team());
             player_spawn(simulation, camera, player);
             std::string name;
             //check string length;
@@ -112,26 +144,26 @@ void Client::on_message(WebSocket *ws, std::string_view message, uint64_t code)
             reader.read<std::string>(name);
             VALIDATE(UTF8Parser::is_valid_utf8(name));
             name = UTF8Parser::trunc_string(name, MAX_NAME_LENGTH);
-            player.set_name(name);
+            player.set_name(StringTable::intern(name));
             break;
         }
         case Serverbound::kPetalDelete: {
             if (!client->alive()) break;
             Simulation *simulation = &client->game->simulation;
             Entity &camera = simulation->get_ent(client->camera);
-            Entity &player = simulation->get_ent(camera.player);
+            Entity &player = simulation->get_ent(camera.player());
             VALIDATE(validator.validate_uint8());
             uint8_t pos = reader.read<uint8_t>();
-            if (pos >= MAX_SLOT_COUNT + player.loadout_count) break;
-            PetalID::T old_id = player.loadout_ids[pos];
+            if (pos >= MAX_SLOT_COUNT + player.loadout_count()) break;
+            PetalID::T old_id = player.loadout_ids(pos);
             if (old_id != PetalID::kNone && old_id != PetalID::kBasic) {
                 uint8_t rarity = PETAL_DATA[old_id].rarity;
                 player.set_score(player.score + RARITY_TO_XP[rarity]);
                 //need to delete if over cap
-                if (player.deleted_petals.size() == player.deleted_petals.capacity())
+                if (player.deleted_petals().size() == player.deleted_petals().capacity())
                     //removes old trashed old petal
-                    PetalTracker::remove_petal(simulation, player.deleted_petals[0]);
-                player.deleted_petals.push_back(old_id);
+                    PetalTracker::remove_petal(simulation, player.deleted_petals()[0]);
+                player.deleted_petals().push_back(old_id);
             }
             player.set_loadout_ids(pos, PetalID::kNone);
             break;
@@ -140,15 +172,15 @@ void Client::on_message(WebSocket *ws, std::string_view message, uint64_t code)
             if (!client->alive()) break;
             Simulation *simulation = &client->game->simulation;
             Entity &camera = simulation->get_ent(client->camera);
-            Entity &player = simulation->get_ent(camera.player);
+            Entity &player = simulation->get_ent(camera.player());
             VALIDATE(validator.validate_uint8());
             uint8_t pos1 = reader.read<uint8_t>();
-            if (pos1 >= MAX_SLOT_COUNT + player.loadout_count) break;
+            if (pos1 >= MAX_SLOT_COUNT + player.loadout_count()) break;
             VALIDATE(validator.validate_uint8());
             uint8_t pos2 = reader.read<uint8_t>();
-            if (pos2 >= MAX_SLOT_COUNT + player.loadout_count) break;
-            PetalID::T tmp = player.loadout_ids[pos1];
-            player.set_loadout_ids(pos1, player.loadout_ids[pos2]);
+            if (pos2 >= MAX_SLOT_COUNT + player.loadout_count()) break;
+            PetalID::T tmp = player.loadout_ids(pos1);
+            player.set_loadout_ids(pos1, player.loadout_ids(pos2));
             player.set_loadout_ids(pos2, tmp);
             break;
         }
@@ -159,6 +191,7 @@ void Client::on_disconnect(WebSocket *ws, int code, std::string_view message) {
     std::cout << "client disconnection\n";
     Client *client = ws->getUserData();
     if (client == nullptr) return;
+    Recorder::on_disconnect(client);
     client->remove();
     //Server::clients.erase(client);
     //delete player in systems
@@ -1,48 +1,78 @@
 #pragma once
 
-#include <Shared/EntityDef.hh>
+#include <Shared/Entity.hh>
 
 #include <cstdint>
-#include <set>
 #include <string>
+#include <vector>
 
-#ifdef WASM_SERVER
+#if defined(WASM_SERVER) || defined(URING_SERVER) || defined(BENCHMARK)
 class WebSocket;
 #else
 #include <App.h>
 class Client;
+#ifdef NO_SSL
+typedef uWS::WebSocket<false, true, Client> WebSocket;
+#else
 typedef uWS::WebSocket<true, true, Client> WebSocket;
 #endif
+#endif
 
 class GameInstance;
 
+namespace CongestionState {
+    enum : uint8_t {
+        kFlowing,
+        kCongested,
+        kResync
+    };
+};
+
 class Client {
 public:
     GameInstance *game;
     EntityID camera;
-    std::set<EntityID> in_view;
+    //sorted, what the client was last sent
+    //reserved for the whole cap when the client joins, so updates never grow it
+    std::vector<EntityID> in_view;
+    //alongside in_view while the client misses updates, the fields changed since its last update
+    //empty once an update gets through, reserved like in_view
+    std::vector<Entity::FieldMask> missed;
+    //a bit per StringTable handle, set once the client has been sent the handle's string
+    //sized for every handle when the client joins
+    std::vector<uint8_t> known_strings;
     WebSocket *ws;
+    std::string address;
     uint8_t verified = 0;
     uint8_t seen_arena = 0;
+    uint8_t congestion = CongestionState::kFlowing;
+    //set by load generators, appends the tick's start time to every update
+    uint8_t tick_timestamps = 0;
+    //0 until the client is first seen by the recorder
+    uint32_t record_id = 0;
     Client();
     void init();
     void remove();
     void disconnect();
     uint8_t alive();
 
-    void send_packet(uint8_t const *, size_t);
+    //0 if the packet was dropped instead of queued
+    uint8_t send_packet(uint8_t const *, size_t);
     static void on_message(WebSocket *, std::string_view, uint64_t);
     static void on_disconnect(WebSocket *, int, std::string_view);
 };
 
-#ifdef WASM_SERVER
+#if defined(WASM_SERVER) || defined(URING_SERVER) || defined(BENCHMARK)
 class WebSocket {
     int ws_id;
 public:
     Client client;
     WebSocket(int);
     Client *getUserData();
-    void send(uint8_t const *, size_t);
+    uint8_t send(uint8_t const *, size_t);
     void end();
+#ifdef URING_SERVER
+    size_t getBufferedAmount() const;
+#endif
 };
 #endif
\ No newline at end of file
@@ -0,0 +1,157 @@
+#include <Server/EntityBudget.hh>
+
+#include <Server/EntityFunctions.hh>
+#include <Server/TickArena.hh>
+
+#include <Shared/Entity.hh>
+#include <Shared/Simulation.hh>
+
+#include <algorithm>
+#include <cmath>
+
+//shares of the cap, player owned entities get whatever is left
+static uint32_t _share(uint8_t category, uint32_t cap) {
+    switch (category) {
+        case BudgetCategory::kZoneMob: return cap / 2;
+        case BudgetCategory::kDrop: return cap / 8;
+        case BudgetCategory::kProjectile: return cap / 8;
+        default: return cap;
+    }
+}
+
+//zone spawns wait below the first, eviction starts below the second and frees up to the third,
+//so a busy arena isn't trimmed a few entities at a time every tick
+static uint32_t _defer_free(uint32_t cap) { return cap / 4; }
+static uint32_t _evict_free(uint32_t cap) { return cap / 8; }
+static uint32_t _target_free(uint32_t cap) { return cap / 8 + cap / 32; }
+//held back from everything but player owned spawns
+static uint32_t _player_reserve(uint32_t cap) { return cap / 32; }
+//despawning is spread out so one tick never pays for a whole sweep of deaths
+static uint32_t _max_evictions(uint32_t cap) { return std::max(cap / 32, 1u); }
+
+struct EvictCandidate {
+    float key;
+    EntityID::id_type id;
+};
+
+EntityBudget::EntityBudget(Simulation *sim) : simulation(sim) {
+    for (uint8_t i = 0; i < BudgetCategory::kNumCategories; ++i) evictions[i] = refusals[i] = 0;
+    reset();
+}
+
+void EntityBudget::reset() {
+    for (uint8_t i = 0; i < BudgetCategory::kNumCategories; ++i) counts[i] = 0;
+}
+
+void EntityBudget::track(Entity &ent, uint8_t category) {
+    DEBUG_ONLY(assert(category < BudgetCategory::kNumCategories && ent.budget_category == BudgetCategory::kPlayerOwned);)
+    ent.budget_category = category;
+    ++counts[category];
+}
+
+void EntityBudget::untrack(Entity const &ent) {
+    if (ent.budget_category == BudgetCategory::kPlayerOwned) return;
+    DEBUG_ONLY(assert(counts[ent.budget_category] > 0);)
+    --counts[ent.budget_category];
+}
+
+uint32_t EntityBudget::count(uint8_t category) const {
+    if (category != BudgetCategory::kPlayerOwned) return counts[category];
+    uint32_t live = simulation->entity_cap() - 1 - simulation->free_slots();
+    return live - counts[BudgetCategory::kZoneMob] - counts[BudgetCategory::kDrop] - counts[BudgetCategory::kProjectile];
+}
+
+uint8_t EntityBudget::can_spawn(uint8_t category, uint32_t count) {
+    uint32_t reserve = category == BudgetCategory::kPlayerOwned ? 0 : _player_reserve(simulation->entity_cap());
+    if (simulation->free_slots() >= count + reserve) return 1;
+    ++refusals[category];
+    return 0;
+}
+
+uint8_t EntityBudget::can_spawn_zone_mob() {
+    uint32_t cap = simulation->entity_cap();
+    if (simulation->free_slots() >= _defer_free(cap) && counts[BudgetCategory::kZoneMob] < _share(BudgetCategory::kZoneMob, cap)) return 1;
+    ++refusals[BudgetCategory::kZoneMob];
+    return 0;
+}
+
+//despawned the same way a drop or web times out, no drops and no score
+static void _evict(Simulation *sim, TickArray<EvictCandidate> &candidates, uint32_t count) {
+    count = std::min(count, candidates.size());
+    if (count == 0) return;
+    //largest key first, ties by id so a replay evicts the same entities
+    auto first = [](EvictCandidate const &a, EvictCandidate const &b) {
+        if (a.key != b.key) return a.key > b.key;
+        return a.id < b.id;
+    };
+    if (count < candidates.size())
+        std::nth_element(candidates.begin(), candidates.begin() + count, candidates.end(), first);
+    for (uint32_t i = 0; i < count; ++i)
+        entity_set_despawn_tick(sim, sim->get_ent_at(candidates[i].id), 0);
+}
+
+void EntityBudget::enforce() {
+    uint32_t cap = simulation->entity_cap();
+    uint32_t free = simulation->free_slots();
+    uint32_t shortfall = free < _evict_free(cap) ? _target_free(cap) - free : 0;
+    uint32_t over[BudgetCategory::kNumCategories] = {0};
+    uint8_t pressured = shortfall > 0;
+    for (uint8_t i = BudgetCategory::kZoneMob; i < BudgetCategory::kNumCategories; ++i) {
+        uint32_t share = _share(i, cap);
+        if (counts[i] > share) over[i] = counts[i] - share;
+        pressured |= over[i] > 0;
+    }
+    if (!pressured) return;
+
+    TickArena::Scope scratch;
+    std::span<EntityID::id_type const> active = simulation->active_ids();
+    TickArray<float> camera_x(active.size());
+    TickArray<EvictCandidate> candidates[BudgetCategory::kNumCategories] = {
+        TickArray<EvictCandidate>(0),
+        TickArray<EvictCandidate>(active.size()),
+        TickArray<EvictCandidate>(active.size()),
+        TickArray<EvictCandidate>(active.size())
+    };
+    //entities already on their way out free their slots within a few ticks, so they count as evicted
+    uint32_t leaving[BudgetCategory::kNumCategories] = {0};
+    for (EntityID::id_type id : active) {
+        Entity &ent = simulation->get_ent_at(id);
+        if (ent.has_component(kCamera)) camera_x.push(ent.camera_x());
+        uint8_t category = ent.budget_category;
+        if (category == BudgetCategory::kPlayerOwned) continue;
+        if (ent.pending_delete() || entity_despawn_due(ent)) {
+            ++leaving[category];
+            continue;
+        }
+        //a mob someone can see would vanish in front of them
+        if (category == BudgetCategory::kZoneMob && !BIT_AT(ent.flags(), EntityFlags::kIsCulled)) continue;
+        candidates[category].push({ (float) ent.lifetime(), id });
+    }
+    //the arena is a long strip, so the distance along it to the nearest camera ranks mobs by how far
+    //they are from every player
+    std::sort(camera_x.begin(), camera_x.end());
+    if (camera_x.size() > 0) {
+        for (EvictCandidate &candidate : candidates[BudgetCategory::kZoneMob]) {
+            float x = simulation->get_ent_at(candidate.id).x();
+            float const *next = std::lower_bound(camera_x.begin(), camera_x.end(), x);
+            float distance = INFINITY;
+            if (next != camera_x.end()) distance = *next - x;
+            if (next != camera_x.begin()) distance = std::min(distance, x - *(next - 1));
+            candidate.key = distance;
+        }
+    }
+
+    uint32_t budget = _max_evictions(cap);
+    for (uint8_t i = BudgetCategory::kZoneMob; i < BudgetCategory::kNumCategories; ++i)
+        shortfall -= std::min(shortfall, leaving[i]);
+    //farthest culled zone mobs first, then the oldest drops, then the oldest projectiles
+    for (uint8_t i = BudgetCategory::kZoneMob; i < BudgetCategory::kNumCategories && budget > 0; ++i) {
+        uint32_t want = over[i] > leaving[i] ? over[i] - leaving[i] : 0;
+        want = std::min(std::max(want, shortfall), budget);
+        uint32_t evicted = std::min(want, candidates[i].size());
+        _evict(simulation, candidates[i], evicted);
+        evictions[i] += evicted;
+        budget -= evicted;
+        shortfall -= std::min(shortfall, evicted);
+    }
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <cstdint>
+
+class Simulation;
+class Entity;
+
+//what an entity is counted as, set when it spawns
+//player owned is the default and is never evicted, which covers cameras, flowers, their petals
+//and the mobs they spawn
+namespace BudgetCategory {
+    enum : uint8_t {
+        kPlayerOwned,
+        kZoneMob,
+        kDrop,
+        kProjectile,
+        kNumCategories
+    };
+};
+
+//keeps the live entity count clear of the cap, each category gets a share of the cap
+//and when free slots run low zone spawns wait, then culled zone mobs, drops and projectiles
+//are despawned to make room for what players do
+//a few slots are kept back from everything but player owned spawns, so a burst of drops or
+//mob spawns in one tick can't take the slots a flower needs
+class EntityBudget {
+    Simulation *simulation;
+    //player owned entities are whatever the other categories don't account for
+    uint32_t counts[BudgetCategory::kNumCategories];
+public:
+    uint64_t evictions[BudgetCategory::kNumCategories];
+    //spawns turned away, natural zone spawns count as zone mobs
+    uint64_t refusals[BudgetCategory::kNumCategories];
+    EntityBudget(Simulation *);
+    void reset();
+    void track(Entity &, uint8_t);
+    void untrack(Entity const &);
+    uint32_t count(uint8_t) const;
+    //0 if spawning that many entities of the category has to wait, callers skip the spawn
+    uint8_t can_spawn(uint8_t, uint32_t);
+    //0 while natural zone spawns are held back, which happens well before anything else waits
+    uint8_t can_spawn_zone_mob();
+    //once a tick after culling, so culled means no camera can see the entity
+    void enforce();
+};
@@ -13,6 +13,11 @@ void entity_on_death(Simulation *, Entity const &);
 
 EntityID find_nearest_enemy(Simulation *, Entity const &, float);
 
-void entity_set_despawn_tick(Entity &, game_tick_t);
+void entity_set_despawn_tick(Simulation *, Entity &, game_tick_t);
+//despawning and out of time, even if post_tick hasn't deleted it yet
+uint8_t entity_despawn_due(Entity const &);
+
+void entity_set_immunity(Entity &, game_tick_t);
+uint8_t entity_is_immune(Entity const &);
 
 void player_update_main_loadout(Simulation *, Entity &, uint32_t, PetalID::T);
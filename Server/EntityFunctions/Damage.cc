@@ -12,9 +12,9 @@ void inflict_damage(Simulation *sim, EntityID const atk_id, EntityID const def_i
     if (!sim->ent_alive(def_id)) return;
     Entity &defender = sim->get_ent(def_id);
     if (!defender.has_component(kHealth)) return;
-    DEBUG_ONLY(assert(!defender.pending_delete);)
+    DEBUG_ONLY(assert(!defender.pending_delete());)
     DEBUG_ONLY(assert(defender.has_component(kHealth));)
-    if (defender.immunity_ticks > 0) return;
+    if (entity_is_immune(defender)) return;
     if (type == DamageType::kContact) amt -= defender.armor;
     else if (type == DamageType::kPoison) amt -= defender.poison_armor;
     if (amt <= 0) return;
@@ -31,7 +31,8 @@ void inflict_damage(Simulation *sim, EntityID const atk_id, EntityID const def_i
         uint32_t end = ceilf((defender.health / defender.max_health) * num_spawn_waves);
         for (uint32_t i = start; i + 1 > end; --i) {
             for (MobID::T mob_id : ANTHOLE_SPAWNS[num_spawn_waves - i]) {
-                Entity &child = alloc_mob(sim, mob_id, defender.x, defender.y, defender.team);
+                if (!sim->budget.can_spawn(mob_budget_category(defender.team()), mob_entity_count(mob_id))) continue;
+                Entity &child = alloc_mob(sim, mob_id, defender.x(), defender.y(), defender.team());
                 child.set_parent(defender.id);
                 child.target = defender.target;
             }
@@ -52,8 +53,8 @@ void inflict_damage(Simulation *sim, EntityID const atk_id, EntityID const def_i
         defender.poison_dealer = atk_id;
     }
 
-    if (defender.slow_ticks < attacker.slow_inflict)
-        defender.slow_ticks = attacker.slow_inflict;
+    if (defender.slow_ticks() < attacker.slow_inflict)
+        defender.slow_ticks() = attacker.slow_inflict;
     
     if (defender.has_component(kPetal)) {
         switch (defender.petal_id) {
@@ -67,8 +68,8 @@ void inflict_damage(Simulation *sim, EntityID const atk_id, EntityID const def_i
 
     if (attacker.has_component(kPetal)) {
         if (!sim->ent_alive(defender.target))
-            defender.target = attacker.parent;
-        defender.last_damaged_by = attacker.parent;
+            defender.target = attacker.parent();
+        defender.last_damaged_by = attacker.parent();
     } else {
         if (!sim->ent_alive(defender.target))
             defender.target = atk_id;
@@ -78,7 +79,7 @@ void inflict_damage(Simulation *sim, EntityID const atk_id, EntityID const def_i
 
 void inflict_heal(Simulation *sim, Entity &ent, float amt) {
     DEBUG_ONLY(assert(ent.has_component(kHealth));)
-    if (ent.pending_delete || ent.health <= 0) return;
+    if (ent.pending_delete() || ent.health <= 0) return;
     if (ent.dandy_ticks > 0) return;
     ent.health = fclamp(ent.health + amt, 0, ent.max_health);
 }
\ No newline at end of file
@@ -12,7 +12,10 @@
 #include <algorithm>
 #include <iostream>
 
-static void _alloc_drops(Simulation *sim, std::vector<PetalID::T> &success_drops, float x, float y) {
+//a mob drops at most its whole drop table, a flower at most 3
+typedef StaticArray<PetalID::T, MAX_DROPS_PER_MOB> drop_list_t;
+
+static void _alloc_drops(Simulation *sim, drop_list_t &success_drops, float x, float y) {
     #ifdef DEBUG
     for (PetalID::T id : success_drops)
         assert(id != PetalID::kNone && id < PetalID::kNumPetals);
@@ -21,19 +24,21 @@ static void _alloc_drops(Simulation *sim, std::vector<PetalID::T> &success_drops
     for (size_t i = count; i > 0; --i) {
         PetalID::T drop_id = success_drops[i - 1];
         if (PETAL_DATA[drop_id].rarity == RarityID::kUnique && PetalTracker::get_count(sim, drop_id) > 0) {
-            success_drops[i] = success_drops[count - 1];
+            success_drops[i - 1] = success_drops[count - 1];
             --count;
-            success_drops.pop_back();
+            success_drops.pop();
             PetalTracker::remove_petal(sim, drop_id);
         }
     }
     DEBUG_ONLY(assert(success_drops.size() == count);)
+    //alloc_drop is what tracks the petals, so a refused drop is simply lost
+    if (count > 0 && !sim->budget.can_spawn(BudgetCategory::kDrop, count)) return;
     if (count > 1) {
         for (size_t i = 0; i < count; ++i) {
             Entity &drop = alloc_drop(sim, success_drops[i]);
             drop.set_x(x);
             drop.set_y(y);
-            drop.velocity.unit_normal(i * 2 * M_PI / count).set_magnitude(25);
+            drop.velocity().unit_normal(i * 2 * M_PI / count).set_magnitude(25);
         }
     } else if (count == 1) {
         Entity &drop = alloc_drop(sim, success_drops[0]);
@@ -47,77 +52,79 @@ static void _add_score(Simulation *sim, EntityID const killer_id, Entity const &
     Entity &killer = sim->get_ent(killer_id);
     if (killer.has_component(kScore))
         killer.set_score(killer.score + target.score_reward);
-    if (target.has_component(kFlower) && sim->ent_alive(target.parent)) {
-        Entity &camera = sim->get_ent(target.parent);
-        if (!killer.has_component(kName)) camera.set_killed_by("");
+    if (target.has_component(kFlower) && sim->ent_alive(target.parent())) {
+        Entity &camera = sim->get_ent(target.parent());
+        if (!killer.has_component(kName)) camera.set_killed_by(StringID());
         else camera.set_killed_by(killer.name);
     }
 }
 
 void entity_on_death(Simulation *sim, Entity const &ent) {
     //don't do on_death for any despawned entity
-    uint8_t natural_despawn = BIT_AT(ent.flags, EntityFlags::kIsDespawning) && ent.despawn_tick == 0;
+    uint8_t natural_despawn = entity_despawn_due(ent);
     if (ent.score_reward > 0 && sim->ent_exists(ent.last_damaged_by) && !natural_despawn) {
         EntityID killer_id = sim->get_ent(ent.last_damaged_by).base_entity;
         _add_score(sim, killer_id, ent);
     }
     if (ent.has_component(kMob)) {
         //if (!(ent.team == NULL_ENTITY)) return;
-        if (BIT_AT(ent.flags, EntityFlags::kSpawnedFromZone))
+        if (BIT_AT(ent.flags(), EntityFlags::kSpawnedFromZone))
             Map::remove_mob(sim, ent.zone);
-        if (!natural_despawn && !(BIT_AT(ent.flags, EntityFlags::kNoDrops))) {
+        if (!natural_despawn && !(BIT_AT(ent.flags(), EntityFlags::kNoDrops))) {
             struct MobData const &mob_data = MOB_DATA[ent.mob_id];
-            std::vector<PetalID::T> success_drops = {};
+            drop_list_t success_drops;
             StaticArray<float, MAX_DROPS_PER_MOB> const &drop_chances = MOB_DROP_CHANCES[ent.mob_id];
             for (uint32_t i = 0; i < mob_data.drops.size(); ++i) 
-                if (frand() < drop_chances[i]) success_drops.push_back(mob_data.drops[i]);
-            _alloc_drops(sim, success_drops, ent.x, ent.y);
+                if (frand() < drop_chances[i]) success_drops.push(mob_data.drops[i]);
+            _alloc_drops(sim, success_drops, ent.x(), ent.y());
         }
-        if (ent.mob_id == MobID::kAntHole && ent.team == NULL_ENTITY && frand() < DIGGER_SPAWN_CHANCE) { 
+        if (ent.mob_id == MobID::kAntHole && ent.team() == NULL_ENTITY && frand() < DIGGER_SPAWN_CHANCE) { 
             EntityID team = NULL_ENTITY;
             if (sim->ent_exists(ent.last_damaged_by))
-                team = sim->get_ent(ent.last_damaged_by).team;
-            alloc_mob(sim, MobID::kDigger, ent.x, ent.y, team);
+                team = sim->get_ent(ent.last_damaged_by).team();
+            if (sim->budget.can_spawn(mob_budget_category(team), 1))
+                alloc_mob(sim, MobID::kDigger, ent.x(), ent.y(), team);
         }
 
     } else if (ent.has_component(kPetal)) {
-        if (ent.petal_id == PetalID::kWeb || ent.petal_id == PetalID::kTriweb)
+        if ((ent.petal_id == PetalID::kWeb || ent.petal_id == PetalID::kTriweb) && sim->budget.can_spawn(BudgetCategory::kProjectile, 1))
             alloc_web(sim, 100, ent);
     } else if (ent.has_component(kFlower)) {
-        std::vector<PetalID::T> potential = {};
-        for (uint32_t i = 0; i < ent.loadout_count + MAX_SLOT_COUNT; ++i) {
-            DEBUG_ONLY(assert(ent.loadout_ids[i] < PetalID::kNumPetals));
-            PetalTracker::remove_petal(sim, ent.loadout_ids[i]);
-            if (ent.loadout_ids[i] != PetalID::kNone && ent.loadout_ids[i] != PetalID::kBasic && frand() < 0.95)
-                potential.push_back(ent.loadout_ids[i]);
+        //every loadout slot and every petal deleted from it
+        StaticArray<PetalID::T, 3 * MAX_SLOT_COUNT> potential;
+        for (uint32_t i = 0; i < ent.loadout_count() + MAX_SLOT_COUNT; ++i) {
+            DEBUG_ONLY(assert(ent.loadout_ids(i) < PetalID::kNumPetals));
+            PetalTracker::remove_petal(sim, ent.loadout_ids(i));
+            if (ent.loadout_ids(i) != PetalID::kNone && ent.loadout_ids(i) != PetalID::kBasic && frand() < 0.95)
+                potential.push(ent.loadout_ids(i));
         }
-        for (uint32_t i = 0; i < ent.deleted_petals.size(); ++i) {
-            DEBUG_ONLY(assert(ent.deleted_petals[i] < PetalID::kNumPetals));
-            PetalTracker::remove_petal(sim, ent.deleted_petals[i]);
-            if (ent.deleted_petals[i] != PetalID::kNone && ent.deleted_petals[i] != PetalID::kBasic && frand() < 0.95)
-                potential.push_back(ent.deleted_petals[i]);
+        for (uint32_t i = 0; i < ent.deleted_petals().size(); ++i) {
+            DEBUG_ONLY(assert(ent.deleted_petals()[i] < PetalID::kNumPetals));
+            PetalTracker::remove_petal(sim, ent.deleted_petals()[i]);
+            if (ent.deleted_petals()[i] != PetalID::kNone && ent.deleted_petals()[i] != PetalID::kBasic && frand() < 0.95)
+                potential.push(ent.deleted_petals()[i]);
         }
         //no need to deleted_petals.clear, the player dies
         std::sort(potential.begin(), potential.end(), [](PetalID::T a, PetalID::T b) {
             return PETAL_DATA[a].rarity < PETAL_DATA[b].rarity;
         });
 
-        std::vector<PetalID::T> success_drops = {};
+        drop_list_t success_drops;
         uint32_t numDrops = potential.size();
         if (numDrops > 3)
             numDrops = 3;
         for (uint32_t i = 0; i < numDrops; ++i) {
             PetalID::T p_id = potential.back();
             if (PETAL_DATA[p_id].rarity >= RarityID::kRare && frand() < 0.05) p_id = PetalID::kPollen;
-            success_drops.push_back(p_id);
-            potential.pop_back();
+            success_drops.push(p_id);
+            potential.pop();
         }
-        _alloc_drops(sim, success_drops, ent.x, ent.y);
+        _alloc_drops(sim, success_drops, ent.x(), ent.y());
         //if the camera is the one that disconnects
         //no need to re-add the petals to the petal tracker
-        if (!sim->ent_alive(ent.parent))
+        if (!sim->ent_alive(ent.parent()))
             return;
-        Entity &camera = sim->get_ent(ent.parent);
+        Entity &camera = sim->get_ent(ent.parent());
         //reset all reloads and stuff
         uint32_t num_left = potential.size();
         //set respawn level
@@ -133,7 +140,7 @@ void entity_on_death(Simulation *sim, Entity const &ent) {
             DEBUG_ONLY(assert(potential.back() < PetalID::kNumPetals));
             PetalTracker::add_petal(sim, potential.back());
             camera.set_inventory(i, potential.back());
-            potential.pop_back();
+            potential.pop();
         }
         //only track up to max_possible
         for (uint32_t i = num_left; i < max_possible; ++i)
@@ -144,7 +151,7 @@ void entity_on_death(Simulation *sim, Entity const &ent) {
             camera.set_inventory(i, PetalID::kBasic);
         }
     } else if (ent.has_component(kDrop)) {
-        if (BIT_AT(ent.flags, EntityFlags::kIsDespawning))
+        if (BIT_AT(ent.flags(), EntityFlags::kIsDespawning))
             PetalTracker::remove_petal(sim, ent.drop_id);
     }
 }
\ No newline at end of file
@@ -3,7 +3,21 @@
 #include <Shared/Entity.hh>
 #include <Shared/Simulation.hh>
 
-void entity_set_despawn_tick(Entity &ent, game_tick_t t) {
-    ent.despawn_tick = t;
-    BIT_SET(ent.flags, EntityFlags::kIsDespawning);
-}
\ No newline at end of file
+//due on the countdown that would have found despawn_tick at 0 if it were counted down every post_tick
+void entity_set_despawn_tick(Simulation *sim, Entity &ent, game_tick_t t) {
+    ent.despawn_at = ent.next_countdown() + t;
+    BIT_SET(ent.flags(), EntityFlags::kIsDespawning);
+    sim->timers.schedule(EntityTimer::kDespawn, ent.id.id, ent.despawn_at);
+}
+
+uint8_t entity_despawn_due(Entity const &ent) {
+    return BIT_AT(ent.flags(), EntityFlags::kIsDespawning) && ent.next_countdown() >= ent.despawn_at;
+}
+
+void entity_set_immunity(Entity &ent, game_tick_t t) {
+    ent.immune_until = ent.next_countdown() + t;
+}
+
+uint8_t entity_is_immune(Entity const &ent) {
+    return ent.next_countdown() < ent.immune_until;
+}
@@ -1,82 +1,166 @@
 #include <Server/Game.hh>
 
+#include <Server/Allocations.hh>
 #include <Server/Client.hh>
 #include <Server/PetalTracker.hh>
 #include <Server/Server.hh>
+#include <Server/Profiler.hh>
+#include <Server/TickArena.hh>
 
 #include <Shared/Binary.hh>
 #include <Shared/Entity.hh>
 #include <Shared/Map.hh>
+#include <Shared/StringTable.hh>
+
+#include <algorithm>
+#include <chrono>
+
+//a handle's string goes out with the first update that gives the client the handle
+static void _note_string(Client *client, TickArray<StringID> &strings, StringID str) {
+    if (str.fixed() || BIT_AT_ARR(client->known_strings, str.id)) return;
+    BIT_SET_ARR(client->known_strings, str.id);
+    strings.push(str);
+}
+
+//the client keeps what it was last sent, so whatever changes on it now has to go out once it catches up
+static void _note_missed(Simulation *sim, Client *client) {
+    if (client->missed.empty()) client->missed.resize(client->in_view.size());
+    for (uint32_t i = 0; i < client->in_view.size(); ++i)
+        if (sim->ent_exists(client->in_view[i]))
+            sim->get_ent(client->in_view[i]).collect_state(client->missed[i]);
+    //the arena only sends deltas too
+    client->seen_arena = 0;
+}
 
 static void _update_client(Simulation *sim, Client *client) {
     if (client == nullptr) return;
     if (!client->verified) return;
     if (sim == nullptr) return;
     if (!sim->ent_exists(client->camera)) return;
-    std::set<EntityID> in_view;
-    std::vector<EntityID> deletes;
-    in_view.insert(client->camera);
+    //let the socket drain instead of queueing deltas the client will receive late
+    if (client->congestion == CongestionState::kCongested) {
+        _note_missed(sim, client);
+        ++Server::net_stats.skipped_clients;
+        return;
+    }
+    PROFILE_SCOPE_ARG(kUpdateClient, client->camera.id);
+    TickArena::Scope scratch;
+    //kept in EntityID order like client->in_view, so both can be walked side by side
+    //the query only finds entities that were active this tick, plus the camera and the player
+    TickArray<EntityID> in_view(sim->active_ids().size() + 2);
+    in_view.push(client->camera);
     Entity &camera = sim->get_ent(client->camera);
-    if (sim->ent_exists(camera.player)) 
-        in_view.insert(camera.player);
+    if (sim->ent_exists(camera.player())) 
+        in_view.push(camera.player());
     Writer writer(Server::OUTGOING_PACKET);
     writer.write<uint8_t>(Clientbound::kClientUpdate);
     writer.write<EntityID>(client->camera);
-    sim->spatial_hash.query(camera.camera_x, camera.camera_y, 960 / camera.fov + 50, 540 / camera.fov + 50, [&](Simulation *, Entity &ent){
-        in_view.insert(ent.id);
-    });
+    //drained after missing updates, this one catches the client up: entities it still has get the fields
+    //that changed since its last update, the rest is created and deleted as usual
+    if (client->congestion == CongestionState::kResync) {
+        client->congestion = CongestionState::kFlowing;
+        ++Server::net_stats.resyncs;
+    }
+    sim->spatial_hash.query(camera.camera_x(), camera.camera_y(), 960 / camera.fov() + 50, 540 / camera.fov() + 50, [&](Simulation *, Entity &ent){
+        in_view.push(ent.id);
+    }, QueryCaller::kUpdateClient);
+    std::sort(in_view.begin(), in_view.end());
+    //the player flower is usually also found by the query
+    uint32_t unique = std::unique(in_view.begin(), in_view.end()) - in_view.begin();
+    while (in_view.size() > unique) in_view.pop();
 
+    uint32_t at = 0;
     for (EntityID const &i: client->in_view) {
-        if (!in_view.contains(i)) {
-            writer.write<EntityID>(i);
-            deletes.push_back(i);
-        }
+        while (at < in_view.size() && in_view[at] < i) ++at;
+        if (at < in_view.size() && in_view[at] == i) continue;
+        writer.write<EntityID>(i);
     }
 
-    for (EntityID const &i : deletes)
-        client->in_view.erase(i);
-
     writer.write<EntityID>(NULL_ENTITY);
     //upcreates
+    TickArray<StringID> strings(in_view.size() + 1 + LEADERBOARD_SIZE);
+    at = 0;
     for (EntityID id: in_view) {
         DEBUG_ONLY(assert(sim->ent_exists(id));)
         Entity &ent = sim->get_ent(id);
-        uint8_t create = !client->in_view.contains(id);
+        while (at < client->in_view.size() && client->in_view[at] < id) ++at;
+        uint8_t create = at == client->in_view.size() || !(client->in_view[at] == id);
         writer.write<EntityID>(id);
-        writer.write<uint8_t>(create | (ent.pending_delete << 1));
-        ent.write(&writer, BIT_AT(create, 0));
-        client->in_view.insert(id);
+        writer.write<uint8_t>(create | (ent.pending_delete() << 1));
+        if (!create && client->missed.size() > 0) ent.write_update(&writer, client->missed[at]);
+        else ent.write(&writer, create);
+        if (ent.has_component(kName)) _note_string(client, strings, ent.name);
+        if (ent.has_component(kCamera)) _note_string(client, strings, ent.killed_by());
     }
     writer.write<EntityID>(NULL_ENTITY);
     //write arena stuff
     writer.write<uint8_t>(client->seen_arena);
     sim->arena_info.write(&writer, client->seen_arena);
     client->seen_arena = 1;
-    client->send_packet(writer.packet, writer.at - writer.packet);
+    for (uint32_t i = 0; i < LEADERBOARD_SIZE; ++i)
+        _note_string(client, strings, sim->arena_info.names[i]);
+    for (StringID str : strings) {
+        writer.write<StringID>(str);
+        StringTable::write(&writer, str);
+    }
+    writer.write<StringID>(StringID());
+    if (client->tick_timestamps) writer.write<uint64_t>(Server::tick_start_us);
+    //Writer doesn't check bounds, a full view of creates is far below this
+    DEBUG_ONLY(assert(writer.at - writer.packet <= MAX_PACKET_LEN);)
+    ALLOC_COUNTING_ONLY(Allocations::Uncounted socket;)
+    if (!client->send_packet(writer.packet, writer.at - writer.packet)) {
+        //dropped, so the client still has its last view and none of these strings
+        _note_missed(sim, client);
+        for (StringID str : strings)
+            BIT_UNSET_ARR(client->known_strings, str.id);
+        return;
+    }
+    client->in_view.assign(in_view.begin(), in_view.end());
+    client->missed.clear();
 }
 
 GameInstance::GameInstance() : simulation(), clients(), team_manager(&simulation) {}
 
 void GameInstance::init() {
-    for (uint32_t i = 0; i < ENTITY_CAP / 2; ++i)
+    //stream 0 is the process-wide one, the game gets its own
+    simulation.rng.seed(Server::seed, 1);
+    RngScope rng(simulation.rng);
+    simulation.reserve(Server::entity_cap);
+    for (uint32_t i = 0; i < simulation.entity_cap() / 2; ++i)
         Map::spawn_random_mob(&simulation);
     team_manager.add_team(ColorID::kBlue);
     team_manager.add_team(ColorID::kRed);
 }
 
 void GameInstance::tick() {
+    RngScope rng(simulation.rng);
     simulation.tick();
-    for (Client *client : clients)
-        _update_client(&simulation, client);
+    {
+        PROFILE_SCOPE(kFanout);
+        auto start = std::chrono::steady_clock::now();
+        for (Client *client : clients)
+            _update_client(&simulation, client);
+        auto end = std::chrono::steady_clock::now();
+        Server::net_stats.send_time = std::chrono::duration<double, std::milli>(end - start).count();
+    }
+    //every client has been sent this tick's handles, so the ones nothing holds any more can be reused
+    StringTable::reclaim([&](StringID str) {
+        for (Client *client : clients)
+            BIT_UNSET_ARR(client->known_strings, str.id);
+    });
     simulation.post_tick();
 }
 
 void GameInstance::add_client(Client *client) {
     DEBUG_ONLY(assert(client->game != this);)
+    RngScope rng(simulation.rng);
     if (client->game != nullptr)
         client->game->remove_client(client);
     client->game = this;
     clients.insert(client);
+    client->in_view.reserve(simulation.entity_cap());
+    client->missed.reserve(simulation.entity_cap());
+    client->known_strings.assign(div_round_up(StringTable::CAPACITY, 8), 0);
     Entity &ent = simulation.alloc_ent();
     ent.add_component(kCamera);
     ent.add_component(kRelations);
@@ -91,12 +175,12 @@ void GameInstance::add_client(Client *client) {
     
     ent.set_fov(BASE_FOV);
     ent.set_respawn_level(1);
-    for (uint32_t i = 0; i < loadout_slots_at_level(ent.respawn_level); ++i)
+    for (uint32_t i = 0; i < loadout_slots_at_level(ent.respawn_level()); ++i)
         ent.set_inventory(i, PetalID::kBasic);
     if (frand() < 0.0001 && PetalTracker::get_count(&simulation, PetalID::kUniqueBasic) == 0)
         ent.set_inventory(0, PetalID::kUniqueBasic);
-    for (uint32_t i = 0; i < loadout_slots_at_level(ent.respawn_level); ++i)
-        PetalTracker::add_petal(&simulation, ent.inventory[i]);
+    for (uint32_t i = 0; i < loadout_slots_at_level(ent.respawn_level()); ++i)
+        PetalTracker::add_petal(&simulation, ent.inventory(i));
     client->camera = ent.id;
     client->seen_arena = 0;
 }
@@ -106,11 +190,15 @@ void GameInstance::remove_client(Client *client) {
     clients.erase(client);
     if (simulation.ent_exists(client->camera)) {
         Entity &c = simulation.get_ent(client->camera);
-        if (simulation.ent_exists(c.player))
-            simulation.request_delete(c.player);
+        if (simulation.ent_exists(c.player()))
+            simulation.request_delete(c.player());
         for (uint32_t i = 0; i < 2 * MAX_SLOT_COUNT; ++i)
-            PetalTracker::remove_petal(&simulation, c.inventory[i]);
+            PetalTracker::remove_petal(&simulation, c.inventory(i));
         simulation.request_delete(client->camera);
     }
     client->game = nullptr;
+}
+
+uint32_t GameInstance::client_count() const {
+    return clients.size();
 }
\ No newline at end of file
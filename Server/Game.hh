@@ -18,4 +18,5 @@ public:
     void tick();
     void add_client(Client *);
     void remove_client(Client *);
+    uint32_t client_count() const;
 };
\ No newline at end of file
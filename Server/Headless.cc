@@ -0,0 +1,33 @@
+#ifdef BENCHMARK
+#include <Server/Client.hh>
+#include <Server/Server.hh>
+
+//in-process transport, clients are driven by calling Client::on_message directly
+//and outgoing packets are only counted
+
+WebSocketServer::WebSocketServer() {}
+
+void Server::run() {}
+
+uint8_t Client::send_packet(uint8_t const *packet, size_t size) {
+    if (ws == nullptr) return 0;
+    ws->send(packet, size);
+    ++Server::net_stats.packets_sent;
+    Server::net_stats.bytes_sent += size;
+    return 1;
+}
+
+WebSocket::WebSocket(int id) : ws_id(id) {
+    client.ws = this;
+}
+
+uint8_t WebSocket::send(uint8_t const *packet, size_t size) { return 1; }
+
+void WebSocket::end() {}
+
+Client *WebSocket::getUserData() {
+    return &client;
+}
+
+WebSocketServer Server::server;
+#endif
@@ -0,0 +1,34 @@
+#ifdef HOT_COUNTERS
+#include <Server/HotCounters.hh>
+
+HotCounterSet HotCounters::tick = {0};
+HotCounterSet HotCounters::totals = {0};
+
+void count_component_alloc(uint32_t comp) {
+    ++HotCounters::tick.allocs[comp];
+}
+
+void count_component_delete(uint32_t comp) {
+    ++HotCounters::tick.deletes[comp];
+}
+
+void HotCounters::begin_tick() {
+    tick = {0};
+}
+
+void HotCounters::end_tick() {
+    totals.candidate_pairs += tick.candidate_pairs;
+    totals.aabb_pairs += tick.aabb_pairs;
+    totals.interact_pairs += tick.interact_pairs;
+    totals.contacts += tick.contacts;
+    for (uint32_t i = 0; i < QueryCaller::kNumCallers; ++i) {
+        totals.query_calls[i] += tick.query_calls[i];
+        totals.query_cells[i] += tick.query_cells[i];
+        totals.query_results[i] += tick.query_results[i];
+    }
+    for (uint32_t i = 0; i < kComponentCount; ++i) {
+        totals.allocs[i] += tick.allocs[i];
+        totals.deletes[i] += tick.deletes[i];
+    }
+}
+#endif
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <Shared/Entity.hh>
+
+#include <cstdint>
+
+#ifdef HOT_COUNTERS
+#define HOT_COUNTERS_ONLY(...) __VA_ARGS__
+#else
+#define HOT_COUNTERS_ONLY(...)
+#endif
+
+//who is asking the spatial hash, so query costs can be split by caller
+namespace QueryCaller {
+    enum : uint8_t {
+        kOther,
+        kCulling,
+        kFindNearestEnemy,
+        kUpdateClient,
+        kNumCallers
+    };
+};
+
+//broadphase, query and entity churn counts, compiled in with -DHOT_COUNTERS
+struct HotCounterSet {
+    //pairs handed to on_collide by SpatialHash::collide
+    uint64_t candidate_pairs;
+    uint64_t aabb_pairs;
+    uint64_t interact_pairs;
+    uint64_t contacts;
+    uint64_t query_calls[QueryCaller::kNumCallers];
+    uint64_t query_cells[QueryCaller::kNumCallers];
+    uint64_t query_results[QueryCaller::kNumCallers];
+    uint64_t allocs[kComponentCount];
+    uint64_t deletes[kComponentCount];
+};
+
+#ifdef HOT_COUNTERS
+namespace HotCounters {
+    //reset at the start of every tick, so between ticks it holds the last tick's counts
+    extern HotCounterSet tick;
+    extern HotCounterSet totals;
+    void begin_tick();
+    void end_tick();
+};
+#endif
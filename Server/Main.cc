@@ -1,16 +1,61 @@
 #include <Shared/Simulation.hh>
+#include <Server/Recorder.hh>
 #include <Server/Server.hh>
 
+#include <cctype>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
 #include <iostream>
 
-int main() {
+static char const *const USAGE = "usage: gardn-server [--seed <n>] [--record <file>] [--entity-cap <n>]\n";
+
+//the whole argument as a decimal number, strtoull alone would take "12ab", "-1" or ""
+static uint8_t _parse_number(char const *arg, uint64_t &out) {
+    if (!std::isdigit(static_cast<unsigned char>(arg[0]))) return 0;
+    char *end;
+    errno = 0;
+    out = std::strtoull(arg, &end, 10);
+    return *end == '\0' && errno == 0;
+}
+
+int main(int argc, char **argv) {
+    Server::seed = std::time(0);
+    char const *record_path = nullptr;
+    for (int i = 1; i < argc; ++i) {
+        if (i + 1 >= argc) {
+            std::cerr << (std::strncmp(argv[i], "--", 2) == 0 ? "missing value for " : "unknown argument ") << argv[i] << '\n' << USAGE;
+            return 1;
+        }
+        char const *flag = argv[i];
+        char const *value = argv[++i];
+        if (std::strcmp(flag, "--seed") == 0) {
+            if (!_parse_number(value, Server::seed)) {
+                std::cerr << "--seed must be a number, got " << value << '\n' << USAGE;
+                return 1;
+            }
+        } else if (std::strcmp(flag, "--record") == 0) record_path = value;
+        else if (std::strcmp(flag, "--entity-cap") == 0) {
+            uint64_t cap;
+            if (!_parse_number(value, cap) || cap < MIN_ENTITY_CAP || cap > MAX_ENTITY_CAP) {
+                std::cerr << "--entity-cap must be between " << MIN_ENTITY_CAP << " and " << MAX_ENTITY_CAP << '\n' << USAGE;
+                return 1;
+            }
+            Server::entity_cap = cap;
+        } else {
+            std::cerr << "unknown argument " << flag << '\n' << USAGE;
+            return 1;
+        }
+    }
     std::cout << "Diagnostics: {\n";
-    std::cout << "  Simulation Size: " << sizeof(Simulation) << '\n';
     std::cout << "  Spatial Hash Size: " << sizeof(SpatialHash) << '\n';
     std::cout << "  Entity Size: " << sizeof(Entity) << '\n';
+    std::cout << "  Entity Cap: " << Server::entity_cap << '\n';
+    std::cout << "  Hot Fields Per Entity: " << EntityHotArrays::bytes_per_entity() << '\n';
+    std::cout << "  Seed: " << Server::seed << '\n';
     std::cout << "}\n";
-    srand(std::time(0));
+    if (record_path != nullptr && !Recorder::open(record_path)) return 1;
     Server::init();
     return 0;
 }
-
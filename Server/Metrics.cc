@@ -0,0 +1,188 @@
+#include <Server/Metrics.hh>
+
+#include <Server/Game.hh>
+#include <Server/HotCounters.hh>
+#include <Server/Profiler.hh>
+#include <Server/Server.hh>
+#include <Server/SpatialHash.hh>
+
+#include <Shared/Entity.hh>
+#include <Shared/Simulation.hh>
+#include <Shared/StaticData.hh>
+#include <Shared/StringTable.hh>
+
+#include <cstdio>
+
+static char const *COMPONENT_NAMES[kComponentCount] = {
+    #define COMPONENT(name) #name,
+    PERCOMPONENT
+    #undef COMPONENT
+};
+
+static void _header(std::string &out, char const *name, char const *type, char const *help) {
+    out += "# HELP ";
+    out += name;
+    out += ' ';
+    out += help;
+    out += "\n# TYPE ";
+    out += name;
+    out += ' ';
+    out += type;
+    out += '\n';
+}
+
+static void _sample(std::string &out, char const *name, char const *labels, double value) {
+    char line[256];
+    if (labels == nullptr) std::snprintf(line, sizeof(line), "%s %.9g\n", name, value);
+    else std::snprintf(line, sizeof(line), "%s{%s} %.9g\n", name, labels, value);
+    out += line;
+}
+
+#ifdef HOT_COUNTERS
+static char const *QUERY_CALLER_NAMES[QueryCaller::kNumCallers] = { "other", "culling", "find_nearest_enemy", "update_client" };
+
+static void _per_caller(std::string &out, char const *name, char const *type, char const *help, uint64_t const *values) {
+    char labels[128];
+    _header(out, name, type, help);
+    for (uint32_t i = 0; i < QueryCaller::kNumCallers; ++i) {
+        std::snprintf(labels, sizeof(labels), "caller=\"%s\"", QUERY_CALLER_NAMES[i]);
+        _sample(out, name, labels, values[i]);
+    }
+}
+
+static void _per_component(std::string &out, char const *name, char const *type, char const *help, uint64_t const *values) {
+    char labels[128];
+    _header(out, name, type, help);
+    for (uint32_t i = 0; i < kComponentCount; ++i) {
+        std::snprintf(labels, sizeof(labels), "component=\"%s\"", COMPONENT_NAMES[i]);
+        _sample(out, name, labels, values[i]);
+    }
+}
+#endif
+
+std::string Metrics::render() {
+    std::string out;
+    char labels[128];
+    Simulation *sim = &Server::game.simulation;
+
+    _header(out, "gardn_clients", "gauge", "Clients attached to the game.");
+    _sample(out, "gardn_clients", nullptr, Server::game.client_count());
+
+    uint32_t component_counts[kComponentCount] = {0};
+    uint32_t entity_count = 0;
+    sim->for_each_entity([&](Simulation *sim, Entity &ent) {
+        if (!sim->ent_exists(ent.id)) return;
+        ++entity_count;
+        for (uint32_t i = 0; i < kComponentCount; ++i)
+            if (ent.has_component(i)) ++component_counts[i];
+    });
+    _header(out, "gardn_entities_total", "gauge", "Live entities.");
+    _sample(out, "gardn_entities_total", nullptr, entity_count);
+    _header(out, "gardn_entities", "gauge", "Live entities by component.");
+    for (uint32_t i = 0; i < kComponentCount; ++i) {
+        std::snprintf(labels, sizeof(labels), "component=\"%s\"", COMPONENT_NAMES[i]);
+        _sample(out, "gardn_entities", labels, component_counts[i]);
+    }
+    _header(out, "gardn_interned_strings", "gauge", "Player names held by the string table.");
+    _sample(out, "gardn_interned_strings", nullptr, StringTable::in_use());
+
+    _header(out, "gardn_zone_mobs", "gauge", "Naturally spawned mobs by zone.");
+    for (uint32_t i = 0; i < MAP.size(); ++i) {
+        std::snprintf(labels, sizeof(labels), "zone=\"%u\",name=\"%s\"", i, MAP[i].name);
+        _sample(out, "gardn_zone_mobs", labels, sim->zone_mob_counts[i]);
+    }
+
+    static char const *BUDGET_CATEGORIES[BudgetCategory::kNumCategories] = { "player_owned", "zone_mob", "drop", "projectile" };
+    _header(out, "gardn_budget_entities", "gauge", "Live entities by budget category.");
+    for (uint32_t i = 0; i < BudgetCategory::kNumCategories; ++i) {
+        std::snprintf(labels, sizeof(labels), "category=\"%s\"", BUDGET_CATEGORIES[i]);
+        _sample(out, "gardn_budget_entities", labels, sim->budget.count(i));
+    }
+    _header(out, "gardn_budget_evictions_total", "counter", "Entities despawned to stay inside the entity budget.");
+    for (uint32_t i = BudgetCategory::kZoneMob; i < BudgetCategory::kNumCategories; ++i) {
+        std::snprintf(labels, sizeof(labels), "category=\"%s\"", BUDGET_CATEGORIES[i]);
+        _sample(out, "gardn_budget_evictions_total", labels, sim->budget.evictions[i]);
+    }
+    _header(out, "gardn_budget_refusals_total", "counter", "Spawns held back by the entity budget.");
+    for (uint32_t i = 0; i < BudgetCategory::kNumCategories; ++i) {
+        std::snprintf(labels, sizeof(labels), "category=\"%s\"", BUDGET_CATEGORIES[i]);
+        _sample(out, "gardn_budget_refusals_total", labels, sim->budget.refusals[i]);
+    }
+
+    _header(out, "gardn_petals", "gauge", "Petals in existence by kind, including loadouts and drops.");
+    for (uint32_t i = PetalID::kBasic; i < PetalID::kNumPetals; ++i) {
+        std::snprintf(labels, sizeof(labels), "petal=\"%s\"", PETAL_DATA[i].name);
+        _sample(out, "gardn_petals", labels, sim->petal_count_tracker[i]);
+    }
+
+    _header(out, "gardn_tick_phase_seconds", "gauge", "Tick phase durations since the last profiler dump.");
+    for (uint32_t i = 0; i < ProfileSection::kNumSections; ++i) {
+        Histogram &h = Profiler::histograms[i];
+        if (h.total.load(std::memory_order_relaxed) == 0) continue;
+        std::snprintf(labels, sizeof(labels), "phase=\"%s\",quantile=\"0.5\"", Profiler::NAMES[i]);
+        _sample(out, "gardn_tick_phase_seconds", labels, h.percentile(50) / 1e9);
+        std::snprintf(labels, sizeof(labels), "phase=\"%s\",quantile=\"0.99\"", Profiler::NAMES[i]);
+        _sample(out, "gardn_tick_phase_seconds", labels, h.percentile(99) / 1e9);
+        std::snprintf(labels, sizeof(labels), "phase=\"%s\",quantile=\"1\"", Profiler::NAMES[i]);
+        _sample(out, "gardn_tick_phase_seconds", labels, h.max.load(std::memory_order_relaxed) / 1e9);
+    }
+
+    NetStats const &last = Server::net_stats;
+    NetStats const &totals = Server::net_totals;
+    _header(out, "gardn_tick_bytes_sent", "gauge", "Snapshot bytes sent in the last tick.");
+    _sample(out, "gardn_tick_bytes_sent", nullptr, last.bytes_sent);
+    _header(out, "gardn_tick_packets_sent", "gauge", "Snapshots sent in the last tick.");
+    _sample(out, "gardn_tick_packets_sent", nullptr, last.packets_sent);
+    _header(out, "gardn_tick_bytes_buffered", "gauge", "Bytes left in socket buffers in the last tick.");
+    _sample(out, "gardn_tick_bytes_buffered", nullptr, last.bytes_buffered);
+    _header(out, "gardn_congested_clients", "gauge", "Clients skipped for backpressure in the last tick.");
+    _sample(out, "gardn_congested_clients", nullptr, last.skipped_clients);
+    _header(out, "gardn_bytes_sent_total", "counter", "Snapshot bytes sent.");
+    _sample(out, "gardn_bytes_sent_total", nullptr, totals.bytes_sent);
+    _header(out, "gardn_packets_sent_total", "counter", "Snapshots sent.");
+    _sample(out, "gardn_packets_sent_total", nullptr, totals.packets_sent);
+    _header(out, "gardn_socket_writes_total", "counter", "Writes issued to client sockets.");
+    _sample(out, "gardn_socket_writes_total", nullptr, Server::transport_stats.socket_writes);
+    _header(out, "gardn_transport_syscalls_total", "counter", "Syscalls made to write to client sockets, io_uring_enter calls on the io_uring server.");
+    _sample(out, "gardn_transport_syscalls_total", nullptr, Server::transport_stats.syscalls);
+    _header(out, "gardn_congestion_skips_total", "counter", "Snapshots skipped for backpressure.");
+    _sample(out, "gardn_congestion_skips_total", nullptr, totals.skipped_clients);
+    _header(out, "gardn_resyncs_total", "counter", "Catch-up updates sent after backpressure cleared.");
+    _sample(out, "gardn_resyncs_total", nullptr, totals.resyncs);
+
+    SpatialHashOccupancy occupancy = sim->spatial_hash.occupancy();
+    _header(out, "gardn_spatial_hash_cells", "gauge", "Cells in the collision grid.");
+    _sample(out, "gardn_spatial_hash_cells", nullptr, occupancy.cells);
+    _header(out, "gardn_spatial_hash_occupied_cells", "gauge", "Cells holding at least one entity.");
+    _sample(out, "gardn_spatial_hash_occupied_cells", nullptr, occupancy.occupied_cells);
+    _header(out, "gardn_spatial_hash_entries", "gauge", "Entity entries across all cells.");
+    _sample(out, "gardn_spatial_hash_entries", nullptr, occupancy.entries);
+    _header(out, "gardn_spatial_hash_max_cell_entries", "gauge", "Entries in the fullest cell.");
+    _sample(out, "gardn_spatial_hash_max_cell_entries", nullptr, occupancy.max_cell_entries);
+
+    #ifdef HOT_COUNTERS
+    HotCounterSet const &tick = HotCounters::tick;
+    HotCounterSet const &hot = HotCounters::totals;
+    _header(out, "gardn_tick_collision_pairs", "gauge", "Broadphase pairs in the last tick by the check they passed.");
+    _sample(out, "gardn_tick_collision_pairs", "stage=\"candidate\"", tick.candidate_pairs);
+    _sample(out, "gardn_tick_collision_pairs", "stage=\"aabb\"", tick.aabb_pairs);
+    _sample(out, "gardn_tick_collision_pairs", "stage=\"interact\"", tick.interact_pairs);
+    _sample(out, "gardn_tick_collision_pairs", "stage=\"contact\"", tick.contacts);
+    _header(out, "gardn_collision_pairs_total", "counter", "Broadphase pairs by the check they passed.");
+    _sample(out, "gardn_collision_pairs_total", "stage=\"candidate\"", hot.candidate_pairs);
+    _sample(out, "gardn_collision_pairs_total", "stage=\"aabb\"", hot.aabb_pairs);
+    _sample(out, "gardn_collision_pairs_total", "stage=\"interact\"", hot.interact_pairs);
+    _sample(out, "gardn_collision_pairs_total", "stage=\"contact\"", hot.contacts);
+    _per_caller(out, "gardn_tick_spatial_queries", "gauge", "Spatial hash queries in the last tick by caller.", tick.query_calls);
+    _per_caller(out, "gardn_tick_spatial_query_cells", "gauge", "Grid cells visited by spatial hash queries in the last tick by caller.", tick.query_cells);
+    _per_caller(out, "gardn_tick_spatial_query_results", "gauge", "Entities returned by spatial hash queries in the last tick by caller.", tick.query_results);
+    _per_caller(out, "gardn_spatial_queries_total", "counter", "Spatial hash queries by caller.", hot.query_calls);
+    _per_caller(out, "gardn_spatial_query_cells_total", "counter", "Grid cells visited by spatial hash queries by caller.", hot.query_cells);
+    _per_caller(out, "gardn_spatial_query_results_total", "counter", "Entities returned by spatial hash queries by caller.", hot.query_results);
+    _per_component(out, "gardn_tick_component_allocs", "gauge", "Components added in the last tick.", tick.allocs);
+    _per_component(out, "gardn_tick_component_deletes", "gauge", "Components freed with their entity in the last tick.", tick.deletes);
+    _per_component(out, "gardn_component_allocs_total", "counter", "Components added.", hot.allocs);
+    _per_component(out, "gardn_component_deletes_total", "counter", "Components freed with their entity.", hot.deletes);
+    #endif
+    return out;
+}
@@ -0,0 +1,8 @@
+#pragma once
+
+#include <string>
+
+namespace Metrics {
+    //prometheus text exposition of the running game, rendered between ticks
+    std::string render();
+};
@@ -2,24 +2,51 @@
 #include <Server/Server.hh>
 
 #include <Server/Client.hh>
+#include <Server/Metrics.hh>
 #include <Shared/Config.hh>
 
-uWS::SSLApp Server::server = uWS::SSLApp({
-    .key_file_name = "misc/key.pem",
-    .cert_file_name = "misc/cert.pem",
-}).ws<Client>("/*", {
+//stop sending updates above the high mark, catch the client up below the low mark
+static size_t const CONGESTION_HIGH_WATER = 4 * MAX_PACKET_LEN;
+static size_t const CONGESTION_LOW_WATER = MAX_PACKET_LEN / 4;
+
+static WebSocketServer _create_app() {
+#ifdef NO_SSL
+    //tls is terminated in front of us
+    return uWS::App();
+#else
+    return uWS::SSLApp({
+        .key_file_name = "misc/key.pem",
+        .cert_file_name = "misc/cert.pem",
+    });
+#endif
+}
+
+WebSocketServer Server::server = _create_app().ws<Client>("/*", {
     /* Settings */
     .compression = uWS::DISABLED,
     .maxPayloadLength = 128,
     .idleTimeout = 15,
     .maxBackpressure = 64 * MAX_PACKET_LEN,
-    .closeOnBackpressureLimit = true,
+    .closeOnBackpressureLimit = false,
     .resetIdleTimeoutOnSend = false,
     .sendPingsAutomatically = true,
     /* Handlers */
-    .upgrade = nullptr,
+    .upgrade = [](auto *res, uWS::HttpRequest *req, struct us_socket_context_t *context) {
+        Client client;
+#ifdef UWS_WITH_PROXY
+        //the address from the PROXY header if the balancer sent one, the socket peer otherwise
+        client.address = res->getProxiedRemoteAddressAsText();
+#else
+        client.address = res->getRemoteAddressAsText();
+#endif
+        res->template upgrade<Client>(std::move(client),
+            req->getHeader("sec-websocket-key"),
+            req->getHeader("sec-websocket-protocol"),
+            req->getHeader("sec-websocket-extensions"),
+            context);
+    },
     .open = [](WebSocket *ws) {
-        std::cout << "client connection\n";
+        std::cout << "client connection " << ws->getUserData()->address << "\n";
         Client *client = ws->getUserData();
         client->ws = ws;
     },
@@ -27,19 +54,20 @@ uWS::SSLApp Server::server = uWS::SSLApp({
         Client::on_message(ws, message, opCode);
     },
     .dropped = [](WebSocket *ws, std::string_view /*message*/, uWS::OpCode /*opCode*/) {
-        std::cout << "dropped packet, uh oh\n";
+        /* A message was dropped due to set maxBackpressure limit */
         Client *client = ws->getUserData();
         if (client == nullptr) {
             ws->end();
             return;
         }
-        client->disconnect();
-        //ws->end();
-        /* A message was dropped due to set maxBackpressure and closeOnBackpressureLimit limit */
+        //the client is missing an update now, it catches up once it drains
+        client->congestion = CongestionState::kCongested;
     },
-    .drain = [](WebSocket */*ws*/) {
-        //assert(!1);
-        /* Check ws->getBufferedAmount() here */
+    .drain = [](WebSocket *ws) {
+        Client *client = ws->getUserData();
+        if (client == nullptr) return;
+        if (client->congestion == CongestionState::kCongested && ws->getBufferedAmount() < CONGESTION_LOW_WATER)
+            client->congestion = CongestionState::kResync;
     },
     .close = [](WebSocket *ws, int code, std::string_view message) {
         Client::on_disconnect(ws, code, message);
@@ -50,6 +78,15 @@ uWS::SSLApp Server::server = uWS::SSLApp({
     }
 });
 
+//side listener on the same loop so scrapes are handled between ticks, never during one
+static uWS::App metrics_server = uWS::App().get("/metrics", [](auto *res, auto *req) {
+    res->writeHeader("Content-Type", "text/plain; version=0.0.4")->end(Metrics::render());
+}).listen("127.0.0.1", METRICS_PORT, [](auto *listen_socket) {
+    if (listen_socket) {
+        std::cout << "Serving metrics on 127.0.0.1:" << METRICS_PORT << std::endl;
+    }
+});
+
 void Server::run() {
     struct us_loop_t *loop = (struct us_loop_t *) uWS::Loop::get();
     struct us_timer_t *delayTimer = us_create_timer(loop, 0, 0);
@@ -59,9 +96,32 @@ void Server::run() {
     Server::server.run();
 }
 
-void Client::send_packet(uint8_t const *packet, size_t size) {
-    if (ws == nullptr) return;
+#ifdef WRAP_SOCKET_WRITES
+//linked with --wrap=us_socket_write, every write uSockets makes goes through here
+//a tls write comes back through it as plain writes of its records, those are what reach the socket
+extern "C" int __real_us_socket_write(int, struct us_socket_t *, char const *, int, int);
+
+extern "C" int __wrap_us_socket_write(int ssl, struct us_socket_t *s, char const *data, int length, int msg_more) {
+    if (!ssl) {
+        ++Server::transport_stats.socket_writes;
+        ++Server::transport_stats.syscalls;
+    }
+    return __real_us_socket_write(ssl, s, data, length, msg_more);
+}
+#endif
+
+uint8_t Client::send_packet(uint8_t const *packet, size_t size) {
+    if (ws == nullptr) return 0;
     std::string_view message(reinterpret_cast<char const *>(packet), size);
-    ws->send(message, uWS::OpCode::BINARY, 0);
+    size_t buffered = ws->getBufferedAmount();
+    //past maxBackpressure, the dropped handler has marked the client congested
+    if (ws->send(message, uWS::OpCode::BINARY, 0) == WebSocket::DROPPED) return 0;
+    ++Server::net_stats.packets_sent;
+    Server::net_stats.bytes_sent += size;
+    size_t now_buffered = ws->getBufferedAmount();
+    if (now_buffered > buffered) Server::net_stats.bytes_buffered += now_buffered - buffered;
+    if (now_buffered > CONGESTION_HIGH_WATER && congestion == CongestionState::kFlowing)
+        congestion = CongestionState::kCongested;
+    return 1;
 }
 #endif
\ No newline at end of file
@@ -28,19 +28,19 @@ static void default_tick_idle_moving(Simulation *sim, Entity &ent) {
     }
     if (ent.ai_tick < 0.5 * TPS) return;
     float r = (ent.ai_tick - 0.5 * TPS) / (2 * TPS);
-    ent.acceleration
-        .unit_normal(ent.angle)
+    ent.acceleration()
+        .unit_normal(ent.angle())
         .set_magnitude(2 * PLAYER_ACCELERATION * (r - r * r));
 }
 
 static void default_tick_returning(Simulation *sim, Entity &ent, float speed = 1.0) {
-    if (!sim->ent_alive(ent.parent)) {
+    if (!sim->ent_alive(ent.parent())) {
         ent.ai_tick = 0;
         ent.ai_state = AIState::kIdle;
         return;
     }
-    Entity &parent = sim->get_ent(ent.parent);
-    Vector delta(parent.x - ent.x, parent.y - ent.y);
+    Entity &parent = sim->get_ent(ent.parent());
+    Vector delta(parent.x() - ent.x(), parent.y() - ent.y());
     if (delta.magnitude() > 300) {
         ent.ai_tick = 0;
     } else if (ent.ai_tick > 2 * TPS || delta.magnitude() < 100) {
@@ -49,7 +49,7 @@ static void default_tick_returning(Simulation *sim, Entity &ent, float speed = 1
         return;
     } 
     delta.set_magnitude(PLAYER_ACCELERATION * speed);
-    ent.acceleration = delta;
+    ent.acceleration() = delta;
     ent.set_angle(delta.angle());
 }
 
@@ -77,9 +77,9 @@ static void tick_default_passive(Simulation *sim, Entity &ent) {
 static void tick_default_neutral(Simulation *sim, Entity &ent) {
     if (sim->ent_alive(ent.target)) {
         Entity &target = sim->get_ent(ent.target);
-        Vector v(target.x - ent.x, target.y - ent.y);
+        Vector v(target.x() - ent.x(), target.y() - ent.y());
         v.set_magnitude(PLAYER_ACCELERATION * 0.975);
-        ent.acceleration = v;
+        ent.acceleration() = v;
         ent.set_angle(v.angle());
         return;
     } else {
@@ -95,10 +95,10 @@ static void tick_default_neutral(Simulation *sim, Entity &ent) {
 static void tick_default_aggro(Simulation *sim, Entity &ent, float speed) {
     if (sim->ent_alive(ent.target)) {
         Entity &target = sim->get_ent(ent.target);
-        Vector v(target.x - ent.x, target.y - ent.y);
+        Vector v(target.x() - ent.x(), target.y() - ent.y());
         _focus_lose_clause(ent, v);
         v.set_magnitude(PLAYER_ACCELERATION * speed);
-        ent.acceleration = v;
+        ent.acceleration() = v;
         ent.set_angle(v.angle());
         return;
     } else {
@@ -107,7 +107,7 @@ static void tick_default_aggro(Simulation *sim, Entity &ent, float speed) {
             ent.ai_tick = 0;
         }
         //if (ent.ai_state != AIState::kReturning) 
-        ent.target = find_nearest_enemy(sim, ent, ent.detection_radius + ent.radius);
+        ent.target = find_nearest_enemy(sim, ent, ent.detection_radius + ent.radius());
         tick_default_passive(sim, ent);
     }
 }
@@ -120,12 +120,12 @@ static void tick_bee_passive(Simulation *sim, Entity &ent) {
                 ent.set_angle(frand() * 2 * M_PI);
                 ent.ai_state = AIState::kIdle;
             }
-            ent.set_angle(ent.angle + 1.5 * sinf(((float) ent.lifetime) / (TPS / 2)) / TPS);
-            Vector v(cosf(ent.angle), sinf(ent.angle));
+            ent.set_angle(ent.angle() + 1.5 * sinf(((float) ent.lifetime()) / (TPS / 2)) / TPS);
+            Vector v(cosf(ent.angle()), sinf(ent.angle()));
             v *= 1.5;
-            if (ent.lifetime % (TPS * 3 / 2) < TPS / 2)
+            if (ent.lifetime() % (TPS * 3 / 2) < TPS / 2)
                 v *= 0.5;
-            ent.acceleration = v;
+            ent.acceleration() = v;
             break;
         }
         case AIState::kIdleMoving: {
@@ -144,17 +144,17 @@ static void tick_bee_passive(Simulation *sim, Entity &ent) {
 static void tick_hornet_aggro(Simulation *sim, Entity &ent) {
     if (sim->ent_alive(ent.target)) {
         Entity &target = sim->get_ent(ent.target);
-        Vector v(target.x - ent.x, target.y - ent.y);
+        Vector v(target.x() - ent.x(), target.y() - ent.y());
         _focus_lose_clause(ent, v);
         float dist = v.magnitude();
         if (dist > 300) {
             v.set_magnitude(PLAYER_ACCELERATION * 0.975);
-            ent.acceleration = v;
+            ent.acceleration() = v;
         } else {
-            ent.acceleration.set(0,0);
+            ent.acceleration().set(0,0);
         }
         ent.set_angle(v.angle());
-        if (ent.ai_tick >= 1.5 * TPS && dist < 800) {
+        if (ent.ai_tick >= 1.5 * TPS && dist < 800 && sim->budget.can_spawn(BudgetCategory::kProjectile, 1)) {
             ent.ai_tick = 0;
             //spawn missile;
             Entity &missile = alloc_petal(sim, PetalID::kMissile, ent);
@@ -162,12 +162,12 @@ static void tick_hornet_aggro(Simulation *sim, Entity &ent) {
             missile.health = missile.max_health = 10;
             //missile.health = missile.max_health = 20;
             //missile.despawn_tick = 1;
-            entity_set_despawn_tick(missile, 3 * TPS);
-            missile.set_angle(ent.angle);
-            missile.acceleration.unit_normal(ent.angle).set_magnitude(40 * PLAYER_ACCELERATION);
+            entity_set_despawn_tick(sim, missile, 3 * TPS);
+            missile.set_angle(ent.angle());
+            missile.acceleration().unit_normal(ent.angle()).set_magnitude(40 * PLAYER_ACCELERATION);
             Vector kb;
-            kb.unit_normal(ent.angle - M_PI).set_magnitude(2.5 * PLAYER_ACCELERATION);
-            ent.velocity += kb;            
+            kb.unit_normal(ent.angle() - M_PI).set_magnitude(2.5 * PLAYER_ACCELERATION);
+            ent.velocity() += kb;            
         }
         return;
     } else {
@@ -184,12 +184,12 @@ static void tick_hornet_aggro(Simulation *sim, Entity &ent) {
 static void tick_centipede_passive(Simulation *sim, Entity &ent) {
     switch(ent.ai_state) {
         case AIState::kIdle: {
-            ent.set_angle(ent.angle + 0.25 / TPS);
+            ent.set_angle(ent.angle() + 0.25 / TPS);
             if (frand() < 1 / (5.0 * TPS)) ent.ai_state = AIState::kIdleMoving;
             break;
         }
         case AIState::kIdleMoving: {
-            ent.set_angle(ent.angle - 0.25 / TPS);
+            ent.set_angle(ent.angle() - 0.25 / TPS);
             if (frand() < 1 / (5.0 * TPS)) ent.ai_state = AIState::kIdle;
             break;
         }
@@ -198,15 +198,15 @@ static void tick_centipede_passive(Simulation *sim, Entity &ent) {
             break;
         }
     }
-    ent.acceleration.unit_normal(ent.angle).set_magnitude(PLAYER_ACCELERATION / 10);
+    ent.acceleration().unit_normal(ent.angle()).set_magnitude(PLAYER_ACCELERATION / 10);
 }
 
 static void tick_centipede_neutral(Simulation *sim, Entity &ent, float speed) {
     if (sim->ent_alive(ent.target)) {
         Entity &target = sim->get_ent(ent.target);
-        Vector v(target.x - ent.x, target.y - ent.y);
+        Vector v(target.x() - ent.x(), target.y() - ent.y());
         v.set_magnitude(PLAYER_ACCELERATION * speed);
-        ent.acceleration = v;
+        ent.acceleration() = v;
         ent.set_angle(v.angle());
         return;
     } else {
@@ -217,15 +217,15 @@ static void tick_centipede_neutral(Simulation *sim, Entity &ent, float speed) {
         //ent.target = find_nearest_enemy(sim, ent, ent.detection_radius + ent.radius);
         switch(ent.ai_state) {
             case AIState::kIdle: {
-                ent.set_angle(ent.angle + 0.25 / TPS);
+                ent.set_angle(ent.angle() + 0.25 / TPS);
                 if (frand() < 1 / (5.0 * TPS)) ent.ai_state = AIState::kIdleMoving;
-                ent.acceleration.unit_normal(ent.angle).set_magnitude(PLAYER_ACCELERATION * speed);
+                ent.acceleration().unit_normal(ent.angle()).set_magnitude(PLAYER_ACCELERATION * speed);
                 break;
             }
             case AIState::kIdleMoving: {
-                ent.set_angle(ent.angle - 0.25 / TPS);
+                ent.set_angle(ent.angle() - 0.25 / TPS);
                 if (frand() < 1 / (5.0 * TPS)) ent.ai_state = AIState::kIdle;
-                ent.acceleration.unit_normal(ent.angle).set_magnitude(PLAYER_ACCELERATION * speed);
+                ent.acceleration().unit_normal(ent.angle()).set_magnitude(PLAYER_ACCELERATION * speed);
                 break;
             }
             case AIState::kReturning: {
@@ -239,10 +239,10 @@ static void tick_centipede_neutral(Simulation *sim, Entity &ent, float speed) {
 static void tick_centipede_aggro(Simulation *sim, Entity &ent) {
     if (sim->ent_alive(ent.target)) {
         Entity &target = sim->get_ent(ent.target);
-        Vector v(target.x - ent.x, target.y - ent.y);
+        Vector v(target.x() - ent.x(), target.y() - ent.y());
         _focus_lose_clause(ent, v);
         v.set_magnitude(PLAYER_ACCELERATION * 0.95);
-        ent.acceleration = v;
+        ent.acceleration() = v;
         ent.set_angle(v.angle());
         return;
     } else {
@@ -250,18 +250,18 @@ static void tick_centipede_aggro(Simulation *sim, Entity &ent) {
             ent.ai_state = AIState::kIdle;
             ent.ai_tick = 0;
         }
-        ent.target = find_nearest_enemy(sim, ent, ent.detection_radius + ent.radius);
+        ent.target = find_nearest_enemy(sim, ent, ent.detection_radius + ent.radius());
         switch(ent.ai_state) {
             case AIState::kIdle: {
-                ent.set_angle(ent.angle + 0.25 / TPS);
+                ent.set_angle(ent.angle() + 0.25 / TPS);
                 if (frand() < 1 / (5.0 * TPS)) ent.ai_state = AIState::kIdleMoving;
-                ent.acceleration.unit_normal(ent.angle).set_magnitude(PLAYER_ACCELERATION / 10);
+                ent.acceleration().unit_normal(ent.angle()).set_magnitude(PLAYER_ACCELERATION / 10);
                 break;
             }
             case AIState::kIdleMoving: {
-                ent.set_angle(ent.angle - 0.25 / TPS);
+                ent.set_angle(ent.angle() - 0.25 / TPS);
                 if (frand() < 1 / (5.0 * TPS)) ent.ai_state = AIState::kIdle;
-                ent.acceleration.unit_normal(ent.angle).set_magnitude(PLAYER_ACCELERATION / 10);
+                ent.acceleration().unit_normal(ent.angle()).set_magnitude(PLAYER_ACCELERATION / 10);
                 break;
             }
             case AIState::kReturning: {
@@ -281,7 +281,7 @@ static void tick_sandstorm(Simulation *sim, Entity &ent) {
                 ent.ai_state = AIState::kIdleMoving;
             }
             Vector rand = Vector::rand(PLAYER_ACCELERATION * 0.5);
-            ent.acceleration.set(rand.x, rand.y);
+            ent.acceleration().set(rand.x, rand.y);
             break;
         }
         case AIState::kIdleMoving: {
@@ -298,7 +298,7 @@ static void tick_sandstorm(Simulation *sim, Entity &ent) {
             rand.unit_normal(ent.heading_angle + frand() * M_PI - M_PI / 2);
             rand.set_magnitude(PLAYER_ACCELERATION * 0.5);
             head += rand;
-            ent.acceleration.set(head.x, head.y);
+            ent.acceleration().set(head.x, head.y);
             break;
         }
         case AIState::kReturning: {
@@ -309,9 +309,9 @@ static void tick_sandstorm(Simulation *sim, Entity &ent) {
             ent.ai_state = AIState::kIdle;
             break;
     }
-    if (sim->ent_alive(ent.parent)) {
-        Entity &parent = sim->get_ent(ent.parent);
-        ent.acceleration = (ent.acceleration + parent.acceleration) * 0.75;
+    if (sim->ent_alive(ent.parent())) {
+        Entity &parent = sim->get_ent(ent.parent());
+        ent.acceleration() = (ent.acceleration() + parent.acceleration()) * 0.75;
     }
 }
 
@@ -319,7 +319,7 @@ static void tick_digger(Simulation *sim, Entity &ent) {
     ent.input = 0;
     if (sim->ent_alive(ent.target)) {
         Entity &target = sim->get_ent(ent.target);
-        Vector v(target.x - ent.x, target.y - ent.y);
+        Vector v(target.x() - ent.x(), target.y() - ent.y());
         _focus_lose_clause(ent, v);
         v.set_magnitude(PLAYER_ACCELERATION * 0.95);
         if (ent.health / ent.max_health > 0.1) {
@@ -328,7 +328,7 @@ static void tick_digger(Simulation *sim, Entity &ent) {
             BIT_SET(ent.input, InputFlags::kDefending);
             v *= -1;
         }
-        ent.acceleration = v;
+        ent.acceleration() = v;
         ent.set_eye_angle(v.angle());
         return;
     } else {
@@ -336,7 +336,7 @@ static void tick_digger(Simulation *sim, Entity &ent) {
             ent.ai_state = AIState::kIdle;
             ent.ai_tick = 0;
         }
-        ent.target = find_nearest_enemy(sim, ent, ent.detection_radius + ent.radius);
+        ent.target = find_nearest_enemy(sim, ent, ent.detection_radius + ent.radius());
         switch(ent.ai_state) {
             case AIState::kIdle: {
                 ent.set_eye_angle(frand() * M_PI * 2);
@@ -347,7 +347,7 @@ static void tick_digger(Simulation *sim, Entity &ent) {
             case AIState::kIdleMoving: {
                 if (ent.ai_tick > 5 * TPS)
                     ent.ai_state = AIState::kIdle;
-                ent.acceleration.unit_normal(ent.eye_angle).set_magnitude(PLAYER_ACCELERATION);
+                ent.acceleration().unit_normal(ent.eye_angle()).set_magnitude(PLAYER_ACCELERATION);
                 break;
             }
             case AIState::kReturning: {
@@ -359,24 +359,24 @@ static void tick_digger(Simulation *sim, Entity &ent) {
 }
 
 void tick_ai_behavior(Simulation *sim, Entity &ent) {
-    if (ent.pending_delete) return;
+    if (ent.pending_delete()) return;
     if (sim->ent_alive(ent.seg_head)) return;
-    ent.acceleration.set(0,0);
-    if (!(ent.parent == NULL_ENTITY)) {
-        if (!sim->ent_alive(ent.parent)) {
-            if (BIT_AT(ent.flags, EntityFlags::kDieOnParentDeath))
+    ent.acceleration().set(0,0);
+    if (!(ent.parent() == NULL_ENTITY)) {
+        if (!sim->ent_alive(ent.parent())) {
+            if (BIT_AT(ent.flags(), EntityFlags::kDieOnParentDeath))
                 sim->request_delete(ent.id);
             ent.set_parent(NULL_ENTITY);
         } else {
-            Entity &parent = sim->get_ent(ent.parent);
-            Vector delta(parent.x - ent.x, parent.y - ent.y);
+            Entity &parent = sim->get_ent(ent.parent());
+            Vector delta(parent.x() - ent.x(), parent.y() - ent.y());
             if (delta.magnitude() > SUMMON_RETREAT_RADIUS) {
                 ent.target = NULL_ENTITY;
                 ent.ai_state = AIState::kReturning;
             }
         }
     }
-    if (BIT_AT(ent.flags, EntityFlags::kIsCulled)) {
+    if (BIT_AT(ent.flags(), EntityFlags::kIsCulled)) {
         ent.target = NULL_ENTITY;
         ent.ai_tick = 0;
         return;
@@ -413,18 +413,18 @@ void tick_ai_behavior(Simulation *sim, Entity &ent) {
             tick_default_aggro(sim, ent, 1.20);
             break;
         case MobID::kSpider:
-            if (ent.lifetime % (TPS) == 0) 
+            if (ent.lifetime() % (TPS) == 0 && sim->budget.can_spawn(BudgetCategory::kProjectile, 1)) 
                 alloc_web(sim, 25, ent);
             tick_default_aggro(sim, ent, 1.20);
             break;
         case MobID::kQueenAnt:
-            if (ent.lifetime % (2 * TPS) == 0) {
+            if (ent.lifetime() % (2 * TPS) == 0 && sim->budget.can_spawn(mob_budget_category(ent.team()), 1)) {
                 Vector behind;
-                behind.unit_normal(ent.angle + M_PI);
-                behind *= ent.radius;
-                Entity &spawned = alloc_mob(sim, MobID::kSoldierAnt, ent.x + behind.x, ent.y + behind.y, ent.team);
-                entity_set_despawn_tick(spawned, 10 * TPS);
-                spawned.set_parent(ent.parent);
+                behind.unit_normal(ent.angle() + M_PI);
+                behind *= ent.radius();
+                Entity &spawned = alloc_mob(sim, MobID::kSoldierAnt, ent.x() + behind.x, ent.y() + behind.y, ent.team());
+                entity_set_despawn_tick(sim, spawned, 10 * TPS);
+                spawned.set_parent(ent.parent());
             }
             tick_default_aggro(sim, ent, 0.95);
             break;
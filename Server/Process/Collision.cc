@@ -1,4 +1,5 @@
 #include <Server/EntityFunctions.hh>
+#include <Server/HotCounters.hh>
 
 #include <Shared/Simulation.hh>
 #include <Shared/Entity.hh>
@@ -9,24 +10,24 @@
 static bool _should_interact(Entity const &ent1, Entity const &ent2) {
     //if (ent1.has_component(kFlower) || ent2.has_component(kFlower)) return false;
     //if (ent1.has_component(kPetal) || ent2.has_component(kPetal)) return false;
-    if (ent1.pending_delete || ent2.pending_delete) return false;
-    if (!(ent1.team == ent2.team)) return true;
-    if (BIT_AT((ent1.flags | ent2.flags), EntityFlags::kNoFriendlyCollision)) return false;
+    if (ent1.pending_delete() || ent2.pending_delete()) return false;
+    if (!(ent1.team() == ent2.team())) return true;
+    if (BIT_AT((ent1.flags() | ent2.flags()), EntityFlags::kNoFriendlyCollision)) return false;
     //if (ent1.has_component(kPetal) || ent2.has_component(kPetal)) return false;
     if (ent1.has_component(kMob) && ent2.has_component(kMob)) return true;
     return false;
 }
 
 static void _pickup_drop(Simulation *sim, Entity &player, Entity &drop) {
-    if (!sim->ent_alive(player.parent)) return;
-    if (drop.immunity_ticks > 0) return;
+    if (!sim->ent_alive(player.parent())) return;
+    if (entity_is_immune(drop)) return;
 
-    for (uint32_t i = 0; i <  player.loadout_count + MAX_SLOT_COUNT; ++i) {
-        if (player.loadout_ids[i] != PetalID::kNone) continue;
+    for (uint32_t i = 0; i <  player.loadout_count() + MAX_SLOT_COUNT; ++i) {
+        if (player.loadout_ids(i) != PetalID::kNone) continue;
         player.set_loadout_ids(i, drop.drop_id);
-        drop.set_x(player.x);
-        drop.set_y(player.y);
-        BIT_UNSET(drop.flags, EntityFlags::kIsDespawning);
+        drop.set_x(player.x());
+        drop.set_y(player.y());
+        BIT_UNSET(drop.flags(), EntityFlags::kIsDespawning);
         sim->request_delete(drop.id);
         //peaceful transfer, no petal tracking needed
         return;
@@ -40,48 +41,56 @@ static void _pickup_drop(Simulation *sim, Entity &player, Entity &drop) {
 static void _deal_push(Entity &ent, Vector knockback, float mass_ratio, float scale) {
     if (fabsf(mass_ratio) < 0.01) return;
     knockback *= scale * mass_ratio;
-    ent.collision_velocity += knockback;
+    ent.collision_velocity() += knockback;
 }
 
 static void _deal_knockback(Entity &ent, Vector knockback, float mass_ratio) {
     if (fabsf(mass_ratio) < 0.01) return;
     float scale = PLAYER_ACCELERATION * 2;
     knockback *= scale * mass_ratio;
-    ent.collision_velocity += knockback;
-    ent.velocity += knockback * 2;
+    ent.collision_velocity() += knockback;
+    ent.velocity() += knockback * 2;
 }
 
 static void _cancel_movement(Entity &ent, Vector dir, Vector add) {
     Vector push = dir;
     push.normalize();
     float dot = fclamp(push.x * add.x + push.y * add.y, PLAYER_ACCELERATION * 0.5, PLAYER_ACCELERATION * 25);
-    ent.velocity += push * (PLAYER_ACCELERATION + dot * 2);
-    ent.collision_velocity += push * (0.5 * PLAYER_ACCELERATION);
+    ent.velocity() += push * (PLAYER_ACCELERATION + dot * 2);
+    ent.collision_velocity() += push * (0.5 * PLAYER_ACCELERATION);
 }
 
-void on_collide(Simulation *sim, Entity &ent1, Entity &ent2) {
+void on_collide(Simulation *sim, EntityID const &id1, EntityID const &id2) {
+    HOT_COUNTERS_ONLY(++HotCounters::tick.candidate_pairs;)
     //do a distance dependent check first (it's faster)
-    float min_dist = ent1.radius + ent2.radius;
-    if (fabs(ent1.x - ent2.x) > min_dist || fabs(ent1.y - ent2.y) > min_dist) return;
+    //it reads the packed arrays, so pairs that are far apart never touch their entities
+    EntityHotArrays const &hot = sim->hot;
+    float min_dist = hot.radius[id1.id] + hot.radius[id2.id];
+    if (fabs(hot.x[id1.id] - hot.x[id2.id]) > min_dist || fabs(hot.y[id1.id] - hot.y[id2.id]) > min_dist) return;
+    HOT_COUNTERS_ONLY(++HotCounters::tick.aabb_pairs;)
+    Entity &ent1 = sim->get_ent(id1);
+    Entity &ent2 = sim->get_ent(id2);
     //check if collide (distance independent)
     if (!_should_interact(ent1, ent2)) return;
+    HOT_COUNTERS_ONLY(++HotCounters::tick.interact_pairs;)
     //finer distance check
-    Vector separation(ent1.x - ent2.x, ent1.y - ent2.y);
+    Vector separation(ent1.x() - ent2.x(), ent1.y() - ent2.y());
     float dist = min_dist - separation.magnitude();
     if (dist < 0) return;
+    HOT_COUNTERS_ONLY(++HotCounters::tick.contacts;)
     if (NO(kDrop) && NO(kWeb)) {
         if (separation.x == 0 && separation.y == 0)
             separation.unit_normal(frand() * 2 * M_PI);
         else
             separation.normalize();
-        float ratio = ent2.mass / (ent1.mass + ent2.mass);
-        if (!(ent1.team == ent2.team)) {
+        float ratio = ent2.mass() / (ent1.mass() + ent2.mass());
+        if (!(ent1.team() == ent2.team())) {
             if (ent1.has_component(kFlower) && !ent2.has_component(kPetal))
-                _cancel_movement(ent1, separation, ent2.velocity - ent1.velocity);
+                _cancel_movement(ent1, separation, ent2.velocity() - ent1.velocity());
             else
                 _deal_knockback(ent1, separation, ratio);
             if (ent2.has_component(kFlower) && !ent1.has_component(kPetal))
-                _cancel_movement(ent2, separation*-1, ent1.velocity - ent2.velocity);
+                _cancel_movement(ent2, separation*-1, ent1.velocity() - ent2.velocity());
             else
                 _deal_knockback(ent2, separation*-1, 1 - ratio);
         }
@@ -89,7 +98,7 @@ void on_collide(Simulation *sim, Entity &ent1, Entity &ent2) {
         _deal_push(ent2, separation*-1, 1 - ratio, dist);
     }
 
-    if (BOTH(kHealth) && !(ent1.team == ent2.team)) {
+    if (BOTH(kHealth) && !(ent1.team() == ent2.team())) {
         if (ent1.health > 0 && ent2.health > 0) {
             inflict_damage(sim, ent1.id, ent2.id, ent1.damage, DamageType::kContact);
             inflict_damage(sim, ent2.id, ent1.id, ent2.damage, DamageType::kContact);
@@ -102,7 +111,7 @@ void on_collide(Simulation *sim, Entity &ent1, Entity &ent2) {
         _pickup_drop(sim, ent1, ent2);
 
     if (ent1.has_component(kWeb) && !ent2.has_component(kPetal) && !ent2.has_component(kDrop))
-        ent2.speed_ratio = 0.5;
+        ent2.speed_ratio() = 0.5;
     if (ent2.has_component(kWeb) && !ent1.has_component(kPetal) && !ent1.has_component(kDrop))
-        ent1.speed_ratio = 0.5;
+        ent1.speed_ratio() = 0.5;
 }
\ No newline at end of file
@@ -8,8 +8,8 @@
 constexpr float CULL_EXTRA_RADIUS = 250;
 
 void tick_culling_behavior(Simulation *sim, Entity &ent) {
-    float fov = fclamp(ent.fov, BASE_FOV * 0.3, BASE_FOV);
-    sim->spatial_hash.query(ent.camera_x, ent.camera_y, 960 / fov + CULL_EXTRA_RADIUS, 540 / fov + CULL_EXTRA_RADIUS, [](Simulation *, Entity &ent) {
-        BIT_UNSET(ent.flags, EntityFlags::kIsCulled);
-    });
+    float fov = fclamp(ent.fov(), BASE_FOV * 0.3, BASE_FOV);
+    sim->spatial_hash.query(ent.camera_x(), ent.camera_y(), 960 / fov + CULL_EXTRA_RADIUS, 540 / fov + CULL_EXTRA_RADIUS, [](Simulation *, Entity &ent) {
+        BIT_UNSET(ent.flags(), EntityFlags::kIsCulled);
+    }, QueryCaller::kCulling);
 }
@@ -26,8 +26,8 @@ static struct PlayerBuffs _get_petal_passive_buffs(Simulation *sim, Entity &play
     if (player.has_component(kMob)) return buffs;
     player.damage_reflection = 0;
     player.poison_armor = 0;
-    for (uint32_t i = 0; i < player.loadout_count; ++i) {
-        LoadoutSlot const &slot = player.loadout[i];
+    for (uint32_t i = 0; i < player.loadout_count(); ++i) {
+        LoadoutSlot const &slot = player.loadout(i);
         PetalID::T slot_petal_id = slot.get_petal_id();
         struct PetalData const &petal_data = PETAL_DATA[slot_petal_id];
         if (slot_petal_id == PetalID::kAntennae) {
@@ -43,7 +43,7 @@ static struct PlayerBuffs _get_petal_passive_buffs(Simulation *sim, Entity &play
         } else if (slot_petal_id == PetalID::kYinYang) {
             ++buffs.yinyang_count;
         }
-        if (!player.loadout[i].already_spawned) continue;
+        if (!player.loadout(i).already_spawned) continue;
         if (slot_petal_id == PetalID::kLeaf) 
             buffs.heal += petal_data.attributes.constant_heal / TPS;
         else if (slot_petal_id == PetalID::kYucca && BIT_AT(player.input, InputFlags::kDefending) && !BIT_AT(player.input, InputFlags::kAttacking)) 
@@ -68,8 +68,8 @@ static struct PlayerBuffs _get_petal_passive_buffs(Simulation *sim, Entity &play
 
 static uint32_t _get_petal_rotation_count(Simulation *sim, Entity &player) {
     uint32_t count = 0;
-    for (uint8_t i = 0; i < player.loadout_count; ++i) {
-        LoadoutSlot const &slot = player.loadout[i];
+    for (uint8_t i = 0; i < player.loadout_count(); ++i) {
+        LoadoutSlot const &slot = player.loadout(i);
         struct PetalData const &petal_data = PETAL_DATA[slot.get_petal_id()];
         if (petal_data.attributes.clump_radius > 0)
             ++count;
@@ -86,7 +86,7 @@ static uint32_t _get_petal_rotation_count(Simulation *sim, Entity &player) {
 }
 
 void tick_player_behavior(Simulation *sim, Entity &player) {
-    if (player.pending_delete) return;
+    if (player.pending_delete()) return;
     DEBUG_ONLY(assert(player.max_health > 0);)
     PlayerBuffs const buffs = _get_petal_passive_buffs(sim, player);
     float health_ratio = player.health / player.max_health;
@@ -108,18 +108,18 @@ void tick_player_behavior(Simulation *sim, Entity &player) {
     //maybe use delta mode for face flags?
     player.set_face_flags(0);
 
-    if (sim->ent_alive(player.parent)) {
-        Entity &camera = sim->get_ent(player.parent);
+    if (sim->ent_alive(player.parent())) {
+        Entity &camera = sim->get_ent(player.parent());
         camera.set_fov(BASE_FOV * (1 - buffs.extra_vision));
     }
 
-    DEBUG_ONLY(assert(player.loadout_count <= MAX_SLOT_COUNT);)
-    for (uint32_t i = 0; i < player.loadout_count; ++i) {
-        LoadoutSlot &slot = player.loadout[i];
+    DEBUG_ONLY(assert(player.loadout_count() <= MAX_SLOT_COUNT);)
+    for (uint32_t i = 0; i < player.loadout_count(); ++i) {
+        LoadoutSlot &slot = player.loadout(i);
         //player.set_loadout_ids(i, slot.id);
         //other way around. loadout_ids should dictate loadout
-        if (slot.get_petal_id() != player.loadout_ids[i] || player.overlevel_timer >= PETAL_DISABLE_DELAY * TPS)
-            slot.update_id(sim, player.loadout_ids[i]);
+        if (slot.get_petal_id() != player.loadout_ids(i) || player.overlevel_timer() >= PETAL_DISABLE_DELAY * TPS)
+            slot.update_id(sim, player.loadout_ids(i));
         PetalID::T slot_petal_id = slot.get_petal_id();
         struct PetalData const &petal_data = PETAL_DATA[slot_petal_id];
         DEBUG_ONLY(assert(petal_data.count <= MAX_PETALS_IN_CLUMP);)
@@ -127,7 +127,7 @@ void tick_player_behavior(Simulation *sim, Entity &player) {
         if (slot_petal_id == PetalID::kNone || petal_data.count == 0)
             continue;
         //if overleveled timer too large
-        if (player.overlevel_timer >= PETAL_DISABLE_DELAY * TPS) {
+        if (player.overlevel_timer() >= PETAL_DISABLE_DELAY * TPS) {
             player.set_loadout_reloads(i, 0);
             continue;
         }
@@ -141,9 +141,12 @@ void tick_player_behavior(Simulation *sim, Entity &player) {
                 float this_reload = reload_time == 0 ? 1 : (float) petal_slot.reload / reload_time;
                 min_reload = std::min(min_reload, this_reload);
                 if (petal_slot.reload >= reload_time) {
-                    petal_slot.ent_id = alloc_petal(sim, slot_petal_id, player).id;
-                    petal_slot.reload = 0;
-                    slot.already_spawned = 1;
+                    //stays reloaded until there is a slot for it
+                    if (sim->budget.can_spawn(BudgetCategory::kPlayerOwned, 1)) {
+                        petal_slot.ent_id = alloc_petal(sim, slot_petal_id, player).id;
+                        petal_slot.reload = 0;
+                        slot.already_spawned = 1;
+                    }
                 } 
                 else
                     ++petal_slot.reload;
@@ -151,24 +154,24 @@ void tick_player_behavior(Simulation *sim, Entity &player) {
             if (sim->ent_alive(petal_slot.ent_id)) {
                 Entity &petal = sim->get_ent(petal_slot.ent_id);
                 //only do this if petal not despawning
-                if (petal.has_component(kPetal) && !(BIT_AT(petal.flags, EntityFlags::kIsDespawning))) {
+                if (petal.has_component(kPetal) && !(BIT_AT(petal.flags(), EntityFlags::kIsDespawning))) {
                     //petal rotation behavior
                     Vector wanting;
-                    Vector delta(player.x - petal.x, player.y - petal.y);
+                    Vector delta(player.x() - petal.x(), player.y() - petal.y());
                     if (rotation_count > 0)
                         wanting.unit_normal(2 * M_PI * rot_pos / rotation_count + player.heading_angle);
 
-                    float range = player.radius + 40;
+                    float range = player.radius() + 40;
                     if (BIT_AT(player.input, InputFlags::kAttacking)) { 
                         if (petal_data.attributes.defend_only == 0) 
-                            range = player.radius + 100 + buffs.extra_range; 
+                            range = player.radius() + 100 + buffs.extra_range; 
                         if (petal.petal_id == PetalID::kWing) {
-                            float wave = sinf((float) petal.lifetime / (0.4 * TPS));
+                            float wave = sinf((float) petal.lifetime() / (0.4 * TPS));
                             wave = wave * wave;
                             range += wave * 120;
                         }
                     }
-                    else if (BIT_AT(player.input, InputFlags::kDefending)) range = player.radius + 15;
+                    else if (BIT_AT(player.input, InputFlags::kDefending)) range = player.radius() + 15;
                     wanting *= range;
                     if (petal_data.attributes.clump_radius > 0) {
                         Vector secondary;
@@ -178,23 +181,24 @@ void tick_player_behavior(Simulation *sim, Entity &player) {
                     }
                     wanting += delta;
                     wanting *= 0.5;
-                    petal.acceleration = wanting;
+                    petal.acceleration() = wanting;
                     game_tick_t sec_reload_ticks = petal_data.attributes.secondary_reload * TPS;
                     if (petal_data.attributes.spawns != MobID::kNumMobs &&
-                        petal.secondary_reload > sec_reload_ticks) {
+                        petal.secondary_reload > sec_reload_ticks &&
+                        sim->budget.can_spawn(BudgetCategory::kPlayerOwned, mob_entity_count(petal_data.attributes.spawns))) {
                         uint8_t spawn_id = petal_data.attributes.spawns;
-                        Entity &mob = alloc_mob(sim, spawn_id, petal.x, petal.y, petal.team);
+                        Entity &mob = alloc_mob(sim, spawn_id, petal.x(), petal.y(), petal.team());
                         mob.set_parent(player.id);
-                        mob.set_color(player.color);
+                        mob.set_color(player.color());
                         mob.base_entity = player.id;
-                        BIT_SET(mob.flags, EntityFlags::kDieOnParentDeath)
-                        BIT_SET(mob.flags, EntityFlags::kNoDrops)
+                        BIT_SET(mob.flags(), EntityFlags::kDieOnParentDeath)
+                        BIT_SET(mob.flags(), EntityFlags::kNoDrops)
                         if (petal_data.attributes.spawn_count == 0) {
                             petal_slot.ent_id = mob.id;
                             sim->request_delete(petal.id);
                             break;
                         } else {
-                            entity_set_despawn_tick(mob, sec_reload_ticks * petal_data.attributes.spawn_count);
+                            entity_set_despawn_tick(sim, mob, sec_reload_ticks * petal_data.attributes.spawn_count);
                             petal.secondary_reload = 0;
                             //needed
                             mob.set_parent(petal.id);
@@ -203,7 +207,7 @@ void tick_player_behavior(Simulation *sim, Entity &player) {
                     }
                 } else {
                     //if petal is a mob, or detached (IsDespawning)
-                    if (BIT_AT(petal.flags, EntityFlags::kIsDespawning))
+                    if (BIT_AT(petal.flags(), EntityFlags::kIsDespawning))
                         petal_slot.ent_id = NULL_ENTITY;
                     if (petal.has_component(kMob))
                         --rot_pos;
@@ -217,21 +221,21 @@ void tick_player_behavior(Simulation *sim, Entity &player) {
         player.set_loadout_reloads(i, min_reload * 255);
     };
     if (BIT_AT(player.input, InputFlags::kAttacking)) 
-        player.set_face_flags(player.face_flags | (1 << FaceFlags::kAttacking));
+        player.set_face_flags(player.face_flags() | (1 << FaceFlags::kAttacking));
     else if (BIT_AT(player.input, InputFlags::kDefending))
-        player.set_face_flags(player.face_flags | (1 << FaceFlags::kDefending));
+        player.set_face_flags(player.face_flags() | (1 << FaceFlags::kDefending));
     if (player.poison_ticks > 0)
-        player.set_face_flags(player.face_flags | (1 << FaceFlags::kPoisoned));
+        player.set_face_flags(player.face_flags() | (1 << FaceFlags::kPoisoned));
     if (player.dandy_ticks > 0)
-        player.set_face_flags(player.face_flags | (1 << FaceFlags::kDandelioned));
+        player.set_face_flags(player.face_flags() | (1 << FaceFlags::kDandelioned));
     if (buffs.extra_range > 0)
-        player.set_face_flags(player.face_flags | (1 << FaceFlags::kThirdEye));
+        player.set_face_flags(player.face_flags() | (1 << FaceFlags::kThirdEye));
     if (buffs.has_antennae)
-        player.set_face_flags(player.face_flags | (1 << FaceFlags::kAntennae));
+        player.set_face_flags(player.face_flags() | (1 << FaceFlags::kAntennae));
     if (buffs.has_observer)
-        player.set_face_flags(player.face_flags | (1 << FaceFlags::kObserver));
+        player.set_face_flags(player.face_flags() | (1 << FaceFlags::kObserver));
     if (buffs.has_cutter)
-        player.set_face_flags(player.face_flags | (1 << FaceFlags::kCutter));
+        player.set_face_flags(player.face_flags() | (1 << FaceFlags::kCutter));
     if (buffs.yinyang_count != MAX_SLOT_COUNT) {
         switch (buffs.yinyang_count % 3) {
             case 0:
@@ -1,30 +1,111 @@
 #include <Server/Process.hh>
 
+#include <Server/TickArena.hh>
+
 #include <Shared/Simulation.hh>
 #include <Shared/Entity.hh>
 
-void tick_entity_motion(Simulation *sim, Entity &ent) {
-    if (ent.pending_delete) return;
-    if (ent.slow_ticks > 0) {
-        ent.speed_ratio *= 0.5;
-        --ent.slow_ticks;
-    }
-    ent.velocity *= (1 - ent.friction);
-    ent.acceleration *= ent.speed_ratio;
-    ent.velocity += ent.acceleration;
-    ent.set_x(ent.x + ent.velocity.x + ent.collision_velocity.x);
-    ent.set_y(ent.y + ent.velocity.y + ent.collision_velocity.y);
-    ent.collision_velocity *= 0.5;
-    ent.velocity += ent.collision_velocity;
-    if (!ent.has_component(kPetal) && !ent.has_component(kWeb)) {
-        ent.set_x(fclamp(ent.x, ent.radius, ARENA_WIDTH - ent.radius));
-        ent.set_y(fclamp(ent.y, ent.radius, ARENA_HEIGHT - ent.radius));
+//two entities per vector, lanes x y x y, so the Vector fields load as they sit in the packed arrays
+//every lane does the same float operations in the same order the per-entity version did, which
+//keeps the results bit for bit identical
+typedef float f32x4 __attribute__((vector_size(16)));
+typedef int32_t i32x4 __attribute__((vector_size(16)));
+
+static f32x4 _pair(Vector const &a, Vector const &b) {
+    return f32x4{ a.x, a.y, b.x, b.y };
+}
+
+static f32x4 _per_entity(float a, float b) {
+    return f32x4{ a, a, b, b };
+}
+
+static i32x4 _per_entity_mask(uint8_t a, uint8_t b) {
+    return i32x4{ -a, -a, -b, -b };
+}
+
+static f32x4 _select(i32x4 mask, f32x4 a, f32x4 b) {
+    return (f32x4) (((i32x4) a & mask) | ((i32x4) b & ~mask));
+}
+
+static void _store(f32x4 v, Vector &a, Vector &b) {
+    a.x = v[0];
+    a.y = v[1];
+    b.x = v[2];
+    b.y = v[3];
+}
+
+//the only per-entity work left, and only for entities that moved or turned
+static void _mark(Simulation *sim, EntityID::id_type id, int32_t moved_x, int32_t moved_y) {
+    uint32_t components = sim->hot.components[id];
+    Vector const &acc = sim->hot.acceleration[id];
+    uint8_t turned = BIT_AT(components, kFlower) && (acc.x != 0 || acc.y != 0);
+    if (!moved_x && !moved_y && !turned) return;
+    Entity &ent = sim->get_ent_at(id);
+    if (moved_x) ent.mark_x();
+    if (moved_y) ent.mark_y();
+    if (turned) ent.set_eye_angle(acc.angle());
+}
+
+void tick_entity_motion(Simulation *sim) {
+    EntityHotArrays &hot = sim->hot;
+    std::span<EntityID::id_type const> active = sim->active_ids();
+    TickArena::Scope scratch;
+    //one spare for the odd one out
+    EntityID::id_type *moving = static_cast<EntityID::id_type *>(TickArena::alloc((active.size() + 1) * sizeof(EntityID::id_type), alignof(EntityID::id_type)));
+    //the same entities for_each<kPhysics> would visit
+    uint32_t count = 0;
+    for (uint32_t i = 0; i < active.size(); ++i) {
+        EntityID::id_type id = active[i];
+        moving[count] = id;
+        count += BIT_AT(hot.components[id], kPhysics) && !hot.pending_delete[id];
     }
-    if (ent.has_component(kFlower)) {
-        if (ent.acceleration.x != 0 || ent.acceleration.y != 0)
-            ent.set_eye_angle(ent.acceleration.angle());
+    if (count == 0) return;
+    //an odd one out is paired with itself, every store below writes the same value from both lanes
+    if (count & 1) moving[count] = moving[count - 1];
+    for (uint32_t i = 0; i < count; i += 2) {
+        EntityID::id_type a = moving[i];
+        EntityID::id_type b = moving[i + 1];
+        game_tick_t slow_a = hot.slow_ticks[a];
+        game_tick_t slow_b = hot.slow_ticks[b];
+        f32x4 speed_ratio = _per_entity(hot.speed_ratio[a] * (slow_a > 0 ? 0.5f : 1.0f),
+            hot.speed_ratio[b] * (slow_b > 0 ? 0.5f : 1.0f));
+        f32x4 velocity = _pair(hot.velocity[a], hot.velocity[b]);
+        f32x4 acceleration = _pair(hot.acceleration[a], hot.acceleration[b]);
+        f32x4 collision_velocity = _pair(hot.collision_velocity[a], hot.collision_velocity[b]);
+        f32x4 pos = f32x4{ hot.x[a], hot.y[a], hot.x[b], hot.y[b] };
+
+        velocity *= _per_entity(1 - hot.friction[a], 1 - hot.friction[b]);
+        acceleration *= speed_ratio;
+        velocity += acceleration;
+        f32x4 moved = pos + velocity + collision_velocity;
+        collision_velocity *= _per_entity(0.5f, 0.5f);
+        velocity += collision_velocity;
+
+        //petals and webs may leave the arena
+        f32x4 lo = _per_entity(hot.radius[a], hot.radius[b]);
+        f32x4 hi = f32x4{ ARENA_WIDTH - hot.radius[a], ARENA_HEIGHT - hot.radius[a],
+            ARENA_WIDTH - hot.radius[b], ARENA_HEIGHT - hot.radius[b] };
+        uint32_t free_mask = (1 << kPetal) | (1 << kWeb);
+        i32x4 clamps = _per_entity_mask((hot.components[a] & free_mask) == 0, (hot.components[b] & free_mask) == 0);
+        f32x4 clamped = _select(~(moved >= lo), lo, _select(~(moved <= hi), hi, moved));
+        f32x4 next = _select(clamps, clamped, moved);
+        //set_x and set_y were each called twice, a field is dirty if either call changed it
+        i32x4 changed = (moved != pos) | (next != moved);
+
+        _store(velocity, hot.velocity[a], hot.velocity[b]);
+        _store(acceleration, hot.acceleration[a], hot.acceleration[b]);
+        hot.collision_velocity[a].set(0, 0);
+        hot.collision_velocity[b].set(0, 0);
+        hot.speed_ratio[a] = 1;
+        hot.speed_ratio[b] = 1;
+        hot.slow_ticks[a] = slow_a - (slow_a > 0);
+        hot.slow_ticks[b] = slow_b - (slow_b > 0);
+        hot.x[a] = next[0];
+        hot.y[a] = next[1];
+        hot.x[b] = next[2];
+        hot.y[b] = next[3];
+
+        _mark(sim, a, changed[0], changed[1]);
+        _mark(sim, b, changed[2], changed[3]);
     }
-    //ent.acceleration.set(0,0);
-    ent.collision_velocity.set(0,0);
-    ent.speed_ratio = 1;
-}
\ No newline at end of file
+}
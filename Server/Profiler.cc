@@ -0,0 +1,135 @@
+#include <Server/Profiler.hh>
+
+#include <algorithm>
+#include <csignal>
+#include <cstdio>
+#include <iostream>
+
+namespace Profiler {
+    std::atomic<uint8_t> enabled = 1;
+    char const *NAMES[ProfileSection::kNumSections] = {
+        "tick",
+        "pre_tick",
+        "spatial_hash",
+        "culling",
+        "budget",
+        "flower",
+        "ai",
+        "petal",
+        "health",
+        "collision",
+        "motion",
+        "segment",
+        "camera",
+        "score",
+        "leaderboard",
+        "fan-out",
+        "update_client",
+        "post_tick",
+        "message"
+    };
+    Histogram histograms[ProfileSection::kNumSections];
+    uint64_t tick_ns[ProfileSection::kNumSections] = {0};
+}
+
+static volatile std::sig_atomic_t dump_requested = 0;
+static volatile std::sig_atomic_t toggle_requested = 0;
+
+uint32_t Histogram::bucket_of(uint64_t v) {
+    if (v < SUB_BUCKETS) return v;
+    uint32_t msb = 63 - __builtin_clzll(v);
+    uint32_t sub = (v >> (msb - SUB_BUCKET_BITS)) & (SUB_BUCKETS - 1);
+    return (msb - SUB_BUCKET_BITS + 1) * SUB_BUCKETS + sub;
+}
+
+uint64_t Histogram::bucket_value(uint32_t bucket) {
+    //midpoint of the bucket's range
+    if (bucket < SUB_BUCKETS) return bucket;
+    uint32_t msb = bucket / SUB_BUCKETS + SUB_BUCKET_BITS - 1;
+    uint64_t sub = bucket % SUB_BUCKETS;
+    uint64_t width = 1ull << (msb - SUB_BUCKET_BITS);
+    return (1ull << msb) + sub * width + width / 2;
+}
+
+void Histogram::record(uint64_t v) {
+    std::atomic<uint64_t> &count = counts[bucket_of(v)];
+    count.store(count.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    total.store(total.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    sum.store(sum.load(std::memory_order_relaxed) + v, std::memory_order_relaxed);
+    if (v > max.load(std::memory_order_relaxed)) max.store(v, std::memory_order_relaxed);
+}
+
+uint64_t Histogram::percentile(double pct) const {
+    uint64_t n = total.load(std::memory_order_relaxed);
+    if (n == 0) return 0;
+    uint64_t rank = pct / 100 * n;
+    if (rank >= n) rank = n - 1;
+    uint64_t seen = 0;
+    for (uint32_t i = 0; i < NUM_BUCKETS; ++i) {
+        seen += counts[i].load(std::memory_order_relaxed);
+        if (seen > rank) return std::min(bucket_value(i), max.load(std::memory_order_relaxed));
+    }
+    return max.load(std::memory_order_relaxed);
+}
+
+void Histogram::reset() {
+    for (uint32_t i = 0; i < NUM_BUCKETS; ++i)
+        counts[i].store(0, std::memory_order_relaxed);
+    total.store(0, std::memory_order_relaxed);
+    sum.store(0, std::memory_order_relaxed);
+    max.store(0, std::memory_order_relaxed);
+}
+
+void Profiler::begin_tick() {
+    for (uint32_t i = 0; i < ProfileSection::kNumSections; ++i)
+        tick_ns[i] = 0;
+}
+
+void Profiler::record(uint8_t section, uint64_t ns) {
+    histograms[section].record(ns);
+    tick_ns[section] += ns;
+}
+
+void Profiler::dump(std::ostream &out) {
+    char line[128];
+    std::snprintf(line, sizeof(line), "%-14s %10s %9s %9s %9s %9s %9s\n",
+        "section (us)", "count", "mean", "p50", "p99", "p99.9", "max");
+    out << line;
+    for (uint32_t i = 0; i < ProfileSection::kNumSections; ++i) {
+        Histogram &h = histograms[i];
+        uint64_t n = h.total.load(std::memory_order_relaxed);
+        if (n == 0) continue;
+        std::snprintf(line, sizeof(line), "%-14s %10llu %9.1f %9.1f %9.1f %9.1f %9.1f\n", NAMES[i],
+            (unsigned long long) n, h.sum.load(std::memory_order_relaxed) / 1e3 / n,
+            h.percentile(50) / 1e3, h.percentile(99) / 1e3, h.percentile(99.9) / 1e3,
+            h.max.load(std::memory_order_relaxed) / 1e3);
+        out << line;
+        h.reset();
+    }
+    out.flush();
+}
+
+#ifndef WASM_SERVER
+static void _on_signal(int sig) {
+    if (sig == SIGUSR1) dump_requested = 1;
+    else if (sig == SIGUSR2) toggle_requested = 1;
+}
+
+void Profiler::install_signal_handlers() {
+    std::signal(SIGUSR1, _on_signal);
+    std::signal(SIGUSR2, _on_signal);
+}
+#else
+void Profiler::install_signal_handlers() {}
+#endif
+
+void Profiler::poll_signals() {
+    if (toggle_requested) {
+        toggle_requested = 0;
+        enabled.store(!enabled.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    }
+    if (dump_requested) {
+        dump_requested = 0;
+        dump(std::cout);
+    }
+}
@@ -0,0 +1,96 @@
+#pragma once
+
+#include <Server/Tracer.hh>
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+
+namespace ProfileSection {
+    enum : uint8_t {
+        kTick,
+        kPreTick,
+        kSpatialHash,
+        kCulling,
+        kBudget,
+        kFlower,
+        kAi,
+        kPetal,
+        kHealth,
+        kCollision,
+        kMotion,
+        kSegment,
+        kCamera,
+        kScore,
+        kLeaderboard,
+        kFanout,
+        kUpdateClient,
+        kPostTick,
+        kMessage,
+        kNumSections
+    };
+};
+
+//log-linear latency histogram in nanoseconds, 8 sub-buckets per power of two (~12% resolution)
+//single writer (the game thread), counters are relaxed atomics so other threads can read them
+class Histogram {
+public:
+    static uint32_t const SUB_BUCKET_BITS = 3;
+    static uint32_t const SUB_BUCKETS = 1 << SUB_BUCKET_BITS;
+    static uint32_t const NUM_BUCKETS = (64 - SUB_BUCKET_BITS + 1) * SUB_BUCKETS;
+    std::atomic<uint64_t> counts[NUM_BUCKETS];
+    std::atomic<uint64_t> total;
+    std::atomic<uint64_t> sum;
+    std::atomic<uint64_t> max;
+
+    static uint32_t bucket_of(uint64_t);
+    static uint64_t bucket_value(uint32_t);
+    void record(uint64_t);
+    uint64_t percentile(double) const;
+    void reset();
+};
+
+namespace Profiler {
+    extern std::atomic<uint8_t> enabled;
+    extern char const *NAMES[ProfileSection::kNumSections];
+    extern Histogram histograms[ProfileSection::kNumSections];
+    //time per section in the current tick, summed over repeated scopes
+    extern uint64_t tick_ns[ProfileSection::kNumSections];
+
+    inline uint64_t now() {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+    void begin_tick();
+    void record(uint8_t, uint64_t);
+    //percentile table of everything recorded since the last dump, then resets
+    void dump(std::ostream &);
+    //SIGUSR1 dumps at the end of the next tick, SIGUSR2 toggles recording
+    void install_signal_handlers();
+    void poll_signals();
+};
+
+class ProfileScope {
+    uint64_t start;
+    uint32_t arg;
+    uint8_t section;
+public:
+    ProfileScope(uint8_t s, uint32_t a = 0) : start(0), arg(a), section(s) {
+#ifdef TRACE
+        start = Profiler::now();
+#else
+        if (Profiler::enabled.load(std::memory_order_relaxed)) start = Profiler::now();
+#endif
+    }
+    ~ProfileScope() {
+        if (start == 0) return;
+        uint64_t end = Profiler::now();
+        if (Profiler::enabled.load(std::memory_order_relaxed)) Profiler::record(section, end - start);
+        TRACE_ONLY(Tracer::record(section, arg, start, end);)
+    }
+};
+
+#define PROFILE_SCOPE(section) ProfileScope _profile_scope(ProfileSection::section)
+//arg is attached to the trace event (eg. the client's camera id)
+#define PROFILE_SCOPE_ARG(section, arg) ProfileScope _profile_scope(ProfileSection::section, arg)
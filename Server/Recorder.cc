@@ -0,0 +1,82 @@
+#include <Server/Recorder.hh>
+
+#include <Server/Client.hh>
+#include <Server/Server.hh>
+
+#include <Shared/Binary.hh>
+#include <Shared/Config.hh>
+#include <Shared/StaticData.hh>
+
+#include <cstdio>
+#include <iostream>
+
+char const Recorder::MAGIC[4] = { 'G', 'R', 'D', 'N' };
+
+static std::FILE *file = nullptr;
+static uint32_t next_id = 1;
+static uint32_t pending_ticks = 0;
+
+static void _write(uint8_t kind, uint32_t value) {
+    uint8_t buf[8];
+    Writer writer(buf);
+    writer.write<uint8_t>(kind);
+    writer.write<uint32_t>(value);
+    std::fwrite(buf, 1, writer.at - writer.packet, file);
+}
+
+static void _write_ticks() {
+    if (pending_ticks == 0) return;
+    _write(RecordKind::kTicks, pending_ticks);
+    pending_ticks = 0;
+}
+
+uint8_t Recorder::open(char const *path) {
+    file = std::fopen(path, "wb");
+    if (file == nullptr) {
+        std::cout << "could not open " << path << " for recording\n";
+        return 0;
+    }
+    std::setvbuf(file, nullptr, _IOFBF, 1 << 20);
+    uint8_t buf[32];
+    Writer writer(buf);
+    for (char c : MAGIC) writer.write<uint8_t>(c);
+    writer.write<uint64_t>(VERSION_HASH);
+    writer.write<uint64_t>(Server::seed);
+    std::fwrite(buf, 1, writer.at - writer.packet, file);
+    if (Server::entity_cap != DEFAULT_ENTITY_CAP)
+        _write(RecordKind::kEntityCap, Server::entity_cap);
+    std::fflush(file);
+    std::cout << "recording session to " << path << '\n';
+    return 1;
+}
+
+void Recorder::on_message(Client *client, std::string_view message) {
+    if (file == nullptr) return;
+    _write_ticks();
+    if (client->record_id == 0) {
+        client->record_id = next_id++;
+        _write(RecordKind::kConnect, client->record_id);
+    }
+    _write(RecordKind::kMessage, client->record_id);
+    uint8_t buf[8];
+    Writer writer(buf);
+    writer.write<uint32_t>(message.size());
+    std::fwrite(buf, 1, writer.at - writer.packet, file);
+    std::fwrite(message.data(), 1, message.size(), file);
+}
+
+void Recorder::on_disconnect(Client *client) {
+    if (file == nullptr) return;
+    //never sent anything, so it never touched the game
+    if (client->record_id == 0) return;
+    _write_ticks();
+    _write(RecordKind::kDisconnect, client->record_id);
+}
+
+void Recorder::end_tick() {
+    if (file == nullptr) return;
+    ++pending_ticks;
+    if (pending_ticks < TPS) return;
+    _write_ticks();
+    std::fflush(file);
+}
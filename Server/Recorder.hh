@@ -0,0 +1,33 @@
+#pragma once
+
+#include <cstdint>
+#include <string_view>
+
+class Client;
+
+//session log, enough to replay a run exactly with gardn-replay:
+//  header: "GRDN" VERSION_HASH seed
+//  records: [kind] [varint], message records also carry [varint length] [payload]
+//a server started with a non default --entity-cap logs it as the first record
+//all integers are protocol varints, written as they happen and flushed once a second
+namespace RecordKind {
+    enum : uint8_t {
+        //varint is the number of ticks that ran since the previous kTicks
+        kTicks,
+        //varint is the client's record id, connects are logged with the client's first message
+        kConnect,
+        kMessage,
+        kDisconnect,
+        //varint is the entity cap the game was started with
+        kEntityCap
+    };
+};
+
+namespace Recorder {
+    extern char const MAGIC[4];
+    //starts recording to path, returns 0 if it can't be opened
+    uint8_t open(char const *);
+    void on_message(Client *, std::string_view);
+    void on_disconnect(Client *);
+    void end_tick();
+};
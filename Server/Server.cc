@@ -1,7 +1,12 @@
 #include <Server/Server.hh>
 
+#include <Server/Allocations.hh>
 #include <Server/Game.hh>
 #include <Server/Client.hh>
+#include <Server/HotCounters.hh>
+#include <Server/Profiler.hh>
+#include <Server/Recorder.hh>
+#include <Server/TickArena.hh>
 
 #include <Shared/Binary.hh>
 
@@ -10,6 +15,12 @@
 
 namespace Server {
     uint8_t OUTGOING_PACKET[MAX_PACKET_LEN] = {0};
+    NetStats net_stats = {0};
+    NetStats net_totals = {0};
+    TransportStats transport_stats = {0};
+    uint64_t seed = 0;
+    uint32_t entity_cap = DEFAULT_ENTITY_CAP;
+    uint64_t tick_start_us = 0;
     GameInstance game;
     std::set<Client *> clients;
     double timestamp;
@@ -18,15 +29,34 @@ namespace Server {
 using namespace Server;
 
 void Server::tick() {
-    using namespace std::chrono_literals;
-    auto start = std::chrono::steady_clock::now();
-    Server::game.tick();
-    auto end = std::chrono::steady_clock::now();
-    std::chrono::duration<double, std::milli> tick_time = end - start;
-    if (tick_time > 5ms) std::cout << "tick took " << tick_time << '\n';
+    Server::net_stats = {0};
+    Server::tick_start_us = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+    Profiler::begin_tick();
+    HOT_COUNTERS_ONLY(HotCounters::begin_tick();)
+    TickArena::reset();
+    ALLOC_COUNTING_ONLY(Allocations::begin_tick();)
+    {
+        PROFILE_SCOPE(kTick);
+        Server::game.tick();
+    }
+    ALLOC_COUNTING_ONLY(Allocations::end_tick();)
+    net_totals.packets_sent += net_stats.packets_sent;
+    net_totals.bytes_sent += net_stats.bytes_sent;
+    net_totals.bytes_buffered += net_stats.bytes_buffered;
+    net_totals.skipped_clients += net_stats.skipped_clients;
+    net_totals.resyncs += net_stats.resyncs;
+    net_totals.send_time += net_stats.send_time;
+    HOT_COUNTERS_ONLY(HotCounters::end_tick();)
+    Recorder::end_tick();
+    Profiler::poll_signals();
+    TRACE_ONLY(Tracer::end_tick();)
 }
 
 void Server::init() {
+    seed_rng(Server::seed);
+    Profiler::install_signal_handlers();
+    TRACE_ONLY(Tracer::install_signal_handlers();)
     Server::game.init();
     Server::run();
 }
@@ -8,18 +8,51 @@ class Client;
 
 size_t const MAX_PACKET_LEN = 64 * 1024;
 
-#ifdef WASM_SERVER
+#if defined(WASM_SERVER) || defined(URING_SERVER) || defined(BENCHMARK)
 class WebSocketServer {
 public:
     WebSocketServer();
 };
 #else
 #include <App.h>
+#ifdef NO_SSL
+typedef uWS::App WebSocketServer;
+#else
 typedef uWS::SSLApp WebSocketServer;
 #endif
+#endif
+
+struct NetStats {
+    //per-tick fan-out counters, reset at the start of every tick
+    uint64_t packets_sent;
+    uint64_t bytes_sent;
+    uint64_t bytes_buffered;
+    uint64_t skipped_clients;
+    uint64_t resyncs;
+    double send_time;
+};
+
+//counted by the transport as writes are made, which can be outside of a tick (a socket draining,
+//or the io_uring fan-out submitted once the tick returns), so there are only running sums
+struct TransportStats {
+    //writes issued to client sockets
+    uint64_t socket_writes;
+    //syscalls made to issue them: one per write for uWS, io_uring_enter calls for io_uring
+    uint64_t syscalls;
+};
 
 namespace Server {
     extern uint8_t OUTGOING_PACKET[MAX_PACKET_LEN];
+    extern NetStats net_stats;
+    //running sums of net_stats over the server's lifetime
+    extern NetStats net_totals;
+    extern TransportStats transport_stats;
+    //seeds every rng stream, so a run can be reproduced with --seed
+    extern uint64_t seed;
+    //how many entity ids the game hands out, set with --entity-cap and sent to every client
+    extern uint32_t entity_cap;
+    //wall clock microseconds at the start of the current tick
+    extern uint64_t tick_start_us;
     //extern Simulation simulation;
     extern GameInstance game;
     extern WebSocketServer server;
@@ -6,77 +6,180 @@
 #include <Server/Server.hh>
 #include <Server/Spawn.hh>
 #include <Server/SpatialHash.hh>
+#include <Server/Profiler.hh>
+#include <Server/StateHash.hh>
+#include <Server/TickArena.hh>
 
 #include <Shared/Map.hh>
 
 #include <algorithm>
-#include <vector>
+#include <functional>
+
+struct RankedPlayer {
+    Entity const *player;
+    uint32_t order;
+};
 
 static void calculate_leaderboard(Simulation *sim) {
-    std::vector<Entity const *> players;
+    PROFILE_SCOPE(kLeaderboard);
+    TickArena::Scope scratch;
+    TickArray<RankedPlayer> players(sim->active_ids().size());
     sim->for_each<kCamera>([&](Simulation *sim, Entity &ent) { 
-        if (sim->ent_alive(ent.player)) players.push_back(&sim->get_ent(ent.player));
-    });
-    std::stable_sort(players.begin(), players.end(), [](Entity const *a, Entity const *b){
-        return a->score > b->score;
+        if (sim->ent_alive(ent.player())) players.push({ &sim->get_ent(ent.player()), players.size() });
     });
     uint32_t num = players.size();
+    uint32_t shown = std::min(num, (uint32_t) LEADERBOARD_SIZE);
+    //ties stay in camera order, as the stable sort used to leave them
+    std::partial_sort(players.begin(), players.begin() + shown, players.end(), [](RankedPlayer const &a, RankedPlayer const &b){
+        if (a.player->score != b.player->score) return a.player->score > b.player->score;
+        return a.order < b.order;
+    });
     sim->arena_info.set_player_count(num);
-    if (num > LEADERBOARD_SIZE) num = LEADERBOARD_SIZE;
-    for (uint32_t i = 0; i < num; ++i) {
-        sim->arena_info.set_names(i, players[i]->name);
-        sim->arena_info.set_scores(i, players[i]->score);
-        sim->arena_info.set_colors(i, players[i]->color);
+    for (uint32_t i = 0; i < shown; ++i) {
+        sim->arena_info.set_names(i, players[i].player->name);
+        sim->arena_info.set_scores(i, players[i].player->score);
+        sim->arena_info.set_colors(i, players[i].player->color());
     }
 }
 
 void Simulation::tick() {
-    pre_tick();
-    spatial_hash.refresh(ARENA_WIDTH, ARENA_HEIGHT);
-    if (frand() < 1.0f / TPS)
-        for (uint32_t i = 0; i < 10; ++i)
-            Map::spawn_random_mob(this);
-    for_each_entity([](Simulation *sim, Entity &ent) {
-        if (ent.has_component(kPhysics))
-            sim->spatial_hash.insert(ent);
-        if (BIT_AT(ent.flags, EntityFlags::kHasCulling))
-            BIT_SET(ent.flags, EntityFlags::kIsCulled);
-    });
-    for_each<kCamera>(tick_culling_behavior);
-    for_each<kFlower>(tick_player_behavior);
-    for_each<kMob>(tick_ai_behavior);
-    for_each<kPetal>(tick_petal_behavior);
-    for_each<kHealth>(tick_health_behavior);
-    spatial_hash.collide(on_collide);
-    for_each<kPhysics>(tick_entity_motion);
-    for_each<kSegmented>(tick_segment_behavior);
-    for_each<kCamera>(tick_camera_behavior);
-    for_each<kScore>(tick_score_behavior);
+    {
+        PROFILE_SCOPE(kPreTick);
+        pre_tick();
+        STATE_HASH_ONLY(if (StateHash::enabled) StateHash::last = StateHash::compute(this);)
+        spatial_hash.refresh(ARENA_WIDTH, ARENA_HEIGHT);
+        if (frand() < 1.0f / TPS)
+            for (uint32_t i = 0; i < 10; ++i)
+                Map::spawn_random_mob(this);
+    }
+    {
+        PROFILE_SCOPE(kSpatialHash);
+        //walks the packed arrays, no entity is touched
+        for (EntityID::id_type id : active_ids()) {
+            if (BIT_AT(hot.components[id], kPhysics))
+                spatial_hash.insert(EntityID(id, hash_tracker[id]));
+            if (BIT_AT(hot.flags[id], EntityFlags::kHasCulling))
+                BIT_SET(hot.flags[id], EntityFlags::kIsCulled);
+        }
+        spatial_hash.sort();
+    }
+    {
+        PROFILE_SCOPE(kCulling);
+        for_each<kCamera>(tick_culling_behavior);
+    }
+    {
+        PROFILE_SCOPE(kBudget);
+        budget.enforce();
+    }
+    {
+        PROFILE_SCOPE(kFlower);
+        for_each<kFlower>(tick_player_behavior);
+    }
+    {
+        PROFILE_SCOPE(kAi);
+        for_each<kMob>(tick_ai_behavior);
+    }
+    {
+        PROFILE_SCOPE(kPetal);
+        for_each<kPetal>(tick_petal_behavior);
+    }
+    {
+        PROFILE_SCOPE(kHealth);
+        for_each<kHealth>(tick_health_behavior);
+    }
+    {
+        PROFILE_SCOPE(kCollision);
+        spatial_hash.collide(on_collide);
+    }
+    {
+        PROFILE_SCOPE(kMotion);
+        tick_entity_motion(this);
+    }
+    {
+        PROFILE_SCOPE(kSegment);
+        for_each<kSegmented>(tick_segment_behavior);
+    }
+    {
+        PROFILE_SCOPE(kCamera);
+        for_each<kCamera>(tick_camera_behavior);
+    }
+    {
+        PROFILE_SCOPE(kScore);
+        for_each<kScore>(tick_score_behavior);
+    }
     calculate_leaderboard(this);
 }
 
+//entities spawned since pre_tick keep their state bits until the next post_tick, so clients that see
+//them a tick late still get their first update
+void Simulation::_clear_dirty() {
+    uint32_t kept = 0;
+    for (uint32_t i = 0; i < hot.dirty_count; ++i) {
+        EntityID::id_type id = hot.dirty[i];
+        Entity &ent = entities[id];
+        if (BIT_AT_ARR(entity_tracker, id) && ent.born == hot.ticks_begun) {
+            hot.dirty[kept++] = id;
+            continue;
+        }
+        ent.reset_protocol();
+        hot.listed_dirty[id] = 0;
+    }
+    hot.dirty_count = kept;
+}
+
+//in id order, which is the order deaths spend the rng and take slots in
+//an entity spawned since pre_tick, or one asked for by an entity with a larger id, waits for the next pass
+//a dying entity comes back through here when its kDeletion timer fires, and not on the ticks between
+void Simulation::_run_deletions() {
+    TickArena::Scope scratch;
+    TickArray<EntityID::id_type> pass(capacity);
+    TickArray<EntityID::id_type> waiting(capacity);
+    auto take_requests = [&](EntityID::id_type after) {
+        for (uint32_t i = 0; i < deletion_count; ++i) {
+            EntityID::id_type id = deletions[i];
+            if (id > after && entities[id].born < hot.ticks_begun) {
+                pass.push(id);
+                std::push_heap(pass.begin(), pass.end(), std::greater<EntityID::id_type>());
+            } else
+                waiting.push(id);
+        }
+        deletion_count = 0;
+    };
+    take_requests(0);
+    while (pass.size() > 0) {
+        std::pop_heap(pass.begin(), pass.end(), std::greater<EntityID::id_type>());
+        EntityID::id_type id = pass.pop();
+        Entity &ent = entities[id];
+        if (!ent.has_component(kPhysics) || ent.died_at != 0) {
+            budget.untrack(ent);
+            for (uint8_t timer = 0; timer < EntityTimer::kNumTimers; ++timer) timers.cancel(timer, id);
+            _delete_ent(ent.id);
+        } else {
+            entity_on_death(this, ent);
+            ent.died_at = hot.countdowns;
+            timers.schedule(EntityTimer::kDeletion, id, hot.countdowns + TPS / 5);
+        }
+        take_requests(id);
+    }
+    for (EntityID::id_type id : waiting) deletions[deletion_count++] = id;
+}
+
 void Simulation::post_tick() {
+    PROFILE_SCOPE(kPostTick);
     arena_info.reset_protocol();
-    for_each_entity([](Simulation *sim, Entity &ent) {
-        //no deletions mid tick
-        ent.reset_protocol();
-        ++ent.lifetime;
-        if (BIT_AT(ent.flags, EntityFlags::kIsDespawning)) {
-            if (ent.despawn_tick == 0)
-                sim->request_delete(ent.id);
-            else
-                --ent.despawn_tick;
+    _clear_dirty();
+    ++hot.countdowns;
+    timers.advance(hot.countdowns, [&](uint8_t timer, EntityID::id_type id) {
+        Entity &ent = entities[id];
+        switch (timer) {
+            case EntityTimer::kDespawn:
+                //picking a drop up stops its despawn without cancelling it
+                if (BIT_AT(ent.flags(), EntityFlags::kIsDespawning)) request_delete(ent.id);
+                break;
+            case EntityTimer::kDeletion:
+                deletions[deletion_count++] = id;
+                break;
         }
-        if (ent.immunity_ticks > 0) --ent.immunity_ticks;
-    });
-    for_each_entity([](Simulation *sim, Entity &ent) {
-        if (!ent.pending_delete) return;
-        if (!ent.has_component(kPhysics)) 
-            return sim->_delete_ent(ent.id);
-        if (ent.deletion_tick >= TPS / 5) 
-            return sim->_delete_ent(ent.id);
-        if (ent.deletion_tick == 0)
-            entity_on_death(sim, ent);
-        ++ent.deletion_tick;
     });
+    _run_deletions();
 }
@@ -0,0 +1,77 @@
+#include <Server/SpatialHash.hh>
+
+#include <Shared/Simulation.hh>
+
+#include <cstring>
+
+//storage shared by both grids, they only differ in which cells an entity goes in and how pairs are found
+
+SpatialHash::SpatialHash(Simulation *sim) : simulation(sim), count(0), sorted(0), query_stamp(0), width(1), height(1) {}
+
+void SpatialHash::reserve(uint32_t entity_cap) {
+    inserted.reserve(entity_cap * HASH_ENTRIES_PER_ENTITY);
+    inserted_cells.reserve(entity_cap * HASH_ENTRIES_PER_ENTITY);
+    entries.reserve(entity_cap * HASH_ENTRIES_PER_ENTITY);
+    first_x.reserve(entity_cap);
+    first_y.reserve(entity_cap);
+    seen.reserve(entity_cap);
+    count = 0;
+    sorted = 0;
+    query_stamp = 0;
+}
+
+//seen comes out of the commit zeroed, which no stamp matches
+void SpatialHash::commit(uint32_t entity_capacity) {
+    inserted.commit(entity_capacity * HASH_ENTRIES_PER_ENTITY);
+    inserted_cells.commit(entity_capacity * HASH_ENTRIES_PER_ENTITY);
+    entries.commit(entity_capacity * HASH_ENTRIES_PER_ENTITY);
+    first_x.commit(entity_capacity);
+    first_y.commit(entity_capacity);
+    seen.commit(entity_capacity);
+}
+
+void SpatialHash::refresh(uint32_t _width, uint32_t _height) {
+    DEBUG_ONLY(assert(_width <= ARENA_WIDTH && _height <= ARENA_HEIGHT));
+    width = div_round_up(_width, GRID_SIZE);
+    height = div_round_up(_height, GRID_SIZE);
+    count = 0;
+    sorted = 0;
+}
+
+void SpatialHash::_append(EntityID const &id, uint32_t x, uint32_t y) {
+    assert(count < inserted.size());
+    inserted[count] = id;
+    inserted_cells[count] = x * MAX_GRID_Y + y;
+    ++count;
+    sorted = 0;
+}
+
+void SpatialHash::sort() {
+    if (sorted) return;
+    uint32_t const cells = MAX_GRID_X * MAX_GRID_Y;
+    std::memset(cell_start, 0, sizeof(cell_start));
+    for (uint32_t i = 0; i < count; ++i)
+        ++cell_start[inserted_cells[i] + 1];
+    for (uint32_t c = 0; c < cells; ++c)
+        cell_start[c + 1] += cell_start[c];
+    std::memcpy(cell_fill, cell_start, sizeof(cell_fill));
+    for (uint32_t i = 0; i < count; ++i)
+        entries[cell_fill[inserted_cells[i]]++] = inserted[i];
+    sorted = 1;
+}
+
+SpatialHashOccupancy SpatialHash::occupancy() {
+    sort();
+    SpatialHashOccupancy ret = { MAX_GRID_X * MAX_GRID_Y, 0, 0, 0 };
+    for (uint32_t x = 0; x < MAX_GRID_X; ++x) {
+        for (uint32_t y = 0; y < MAX_GRID_Y; ++y) {
+            uint32_t size;
+            _cell(x, y, size);
+            if (size == 0) continue;
+            ++ret.occupied_cells;
+            ret.entries += size;
+            if (size > ret.max_cell_entries) ret.max_cell_entries = size;
+        }
+    }
+    return ret;
+}
@@ -1,11 +1,11 @@
 #pragma once
 
+#include <Server/HotCounters.hh>
+
 #include <Shared/Entity.hh>
 #include <Shared/StaticData.hh>
 
 #include <cstdint>
-#include <functional>
-#include <vector>
 
 class Simulation;
 class Entity;
@@ -13,16 +13,50 @@ class Entity;
 static const uint32_t GRID_SIZE = 100 * 2;
 static const uint32_t MAX_GRID_X = div_round_up(ARENA_WIDTH, GRID_SIZE);
 static const uint32_t MAX_GRID_Y = div_round_up(ARENA_HEIGHT, GRID_SIZE);
+//the canonical grid puts an entity in every cell it overlaps
+static const uint32_t HASH_ENTRIES_PER_ENTITY = 4;
+
+struct SpatialHashOccupancy {
+    uint32_t cells;
+    uint32_t occupied_cells;
+    uint32_t entries;
+    uint32_t max_cell_entries;
+};
 
 class SpatialHash {
     Simulation *simulation;
-    std::vector<EntityID> cells[MAX_GRID_X][MAX_GRID_Y];
+    //inserts are appended as they come, then grouped by cell with one counting sort so every cell
+    //is a run of entries, in insertion order, and nothing is allocated
+    //sized along with the simulation's entity slots
+    ReservedArray<EntityID> inserted;
+    ReservedArray<uint32_t> inserted_cells;
+    ReservedArray<EntityID> entries;
+    uint32_t cell_start[MAX_GRID_X * MAX_GRID_Y + 1];
+    uint32_t cell_fill[MAX_GRID_X * MAX_GRID_Y];
+    uint32_t count;
+    uint8_t sorted;
+    //SpatialHashCanonical only, the first cell of each entity's range and the query dedup stamps
+    ReservedArray<uint16_t> first_x;
+    ReservedArray<uint16_t> first_y;
+    ReservedArray<uint32_t> seen;
+    uint32_t query_stamp;
     uint32_t width;
     uint32_t height;
+    void _append(EntityID const &, uint32_t, uint32_t);
+    //inline, queries look at many empty cells
+    EntityID const *_cell(uint32_t x, uint32_t y, uint32_t &size) const {
+        uint32_t cell = x * MAX_GRID_Y + y;
+        size = cell_start[cell + 1] - cell_start[cell];
+        return entries.data() + cell_start[cell];
+    }
 public:
     SpatialHash(Simulation *);
+    void reserve(uint32_t);
+    void commit(uint32_t);
     void refresh(uint32_t, uint32_t);
-    void insert(Entity const &);
-    void collide(std::function<void(Simulation *, Entity &, Entity &)>);
-    void query(float, float, float, float, std::function<void(Simulation *, Entity &)>);
+    void insert(EntityID const &);
+    void sort();
+    void collide(FunctionRef<void(Simulation *, EntityID const &, EntityID const &)>);
+    void query(float, float, float, float, FunctionRef<void(Simulation *, Entity &)>, uint8_t = QueryCaller::kOther);
+    SpatialHashOccupancy occupancy();
 };
\ No newline at end of file
@@ -3,71 +3,73 @@
 #include <Shared/Simulation.hh>
 #include <Shared/Entity.hh>
 
-#include <unordered_set>
+#include <algorithm>
+#include <cstring>
 
-static uint32_t _hash_two(EntityID const a, EntityID const b) {
-    if (a.id > b.id) return (a.id << 16) + b.id;
-    else return (b.id << 16) + a.id;
-}
-
-SpatialHash::SpatialHash(Simulation *sim) : simulation(sim), width(1), height(1) {}
-
-void SpatialHash::refresh(uint32_t _width, uint32_t _height) {
-    DEBUG_ONLY(assert(_width <= ARENA_WIDTH && _height <= ARENA_HEIGHT));
-    width = div_round_up(_width, GRID_SIZE);
-    height = div_round_up(_height, GRID_SIZE);
-    for (uint32_t x = 0; x < MAX_GRID_X; ++x)
-        for (uint32_t y = 0; y < MAX_GRID_Y; ++y)
-            cells[x][y].clear();
-}
-
-void SpatialHash::insert(Entity const &ent) {
-    DEBUG_ONLY(assert(ent.has_component(kPhysics));)
-    uint32_t sx = fclamp(ent.x - ent.radius, 0, ARENA_WIDTH - 1) / GRID_SIZE;
-    uint32_t sy = fclamp(ent.y - ent.radius, 0, ARENA_HEIGHT - 1) / GRID_SIZE;
-    uint32_t ex = fclamp(ent.x + ent.radius, 0, ARENA_WIDTH - 1) / GRID_SIZE;
-    uint32_t ey = fclamp(ent.y + ent.radius, 0, ARENA_HEIGHT - 1) / GRID_SIZE;
+void SpatialHash::insert(EntityID const &id) {
+    EntityHotArrays const &hot = simulation->hot;
+    DEBUG_ONLY(assert(BIT_AT(hot.components[id.id], kPhysics));)
+    uint32_t sx = fclamp(hot.x[id.id] - hot.radius[id.id], 0, ARENA_WIDTH - 1) / GRID_SIZE;
+    uint32_t sy = fclamp(hot.y[id.id] - hot.radius[id.id], 0, ARENA_HEIGHT - 1) / GRID_SIZE;
+    uint32_t ex = fclamp(hot.x[id.id] + hot.radius[id.id], 0, ARENA_WIDTH - 1) / GRID_SIZE;
+    uint32_t ey = fclamp(hot.y[id.id] + hot.radius[id.id], 0, ARENA_HEIGHT - 1) / GRID_SIZE;
+    first_x[id.id] = sx;
+    first_y[id.id] = sy;
     for (uint32_t x = sx; x <= ex; ++x)
         for (uint32_t y = sy; y <= ey; ++y)
-            cells[x][y].push_back(ent.id);
+            _append(id, x, y);
 }
 
-void SpatialHash::collide(std::function<void(Simulation *, Entity &, Entity &)> on_collide) {
-    std::unordered_set<uint32_t> seen_collisions;
+void SpatialHash::collide(FunctionRef<void(Simulation *, EntityID const &, EntityID const &)> on_collide) {
+    sort();
     for (uint32_t x = 0; x < MAX_GRID_X; ++x) {
         for (uint32_t y = 0; y < MAX_GRID_Y; ++y) {
-            std::vector<EntityID> const &cell = cells[x][y];
-            for (uint32_t i = 0; i < cell.size(); ++i) {
-                for (uint32_t j = i + 1; j < cell.size(); ++j) {
-                    uint32_t comb_hash = _hash_two(cell[i], cell[j]);
-                    if (seen_collisions.contains(comb_hash)) continue;
-                    on_collide(simulation, simulation->get_ent(cell[i]), simulation->get_ent(cell[j]));
-                    seen_collisions.insert(comb_hash);
+            uint32_t size;
+            EntityID const *cell = _cell(x, y, size);
+            for (uint32_t i = 0; i < size; ++i) {
+                for (uint32_t j = i + 1; j < size; ++j) {
+                    //two entities sharing several cells collide in the first of them, where the
+                    //top left corners of their ranges meet, so no set of seen pairs is needed
+                    if (std::max(first_x[cell[i].id], first_x[cell[j].id]) != x) continue;
+                    if (std::max(first_y[cell[i].id], first_y[cell[j].id]) != y) continue;
+                    on_collide(simulation, cell[i], cell[j]);
                 }
             }
         }
     }
 }
 
-void SpatialHash::query(float x, float y, float w, float h, std::function<void(Simulation *, Entity &)> cb) {
-    std::unordered_set<EntityID::id_type> seen_entities;
+void SpatialHash::query(float x, float y, float w, float h, FunctionRef<void(Simulation *, Entity &)> cb, uint8_t caller) {
+    sort();
+    //an entity is seen once per query however many of the cells it is in
+    if (++query_stamp == 0) {
+        std::memset(seen.data(), 0, seen.size() * sizeof(uint32_t));
+        query_stamp = 1;
+    }
     uint32_t sx = fclamp(x - w, 0, ARENA_WIDTH - 1) / GRID_SIZE;
     uint32_t sy = fclamp(y - h, 0, ARENA_HEIGHT - 1) / GRID_SIZE;
     uint32_t ex = fclamp(x + w, 0, ARENA_WIDTH - 1) / GRID_SIZE;
     uint32_t ey = fclamp(y + h, 0, ARENA_HEIGHT - 1) / GRID_SIZE;
+    HOT_COUNTERS_ONLY(
+        ++HotCounters::tick.query_calls[caller];
+        HotCounters::tick.query_cells[caller] += (ex - sx + 1) * (ey - sy + 1);
+    )
+    EntityHotArrays const &hot = simulation->hot;
     for (uint32_t _x = sx; _x <= ex; ++_x) {
         for (uint32_t _y = sy; _y <= ey; ++_y) {
-            std::vector<EntityID> const &cell = cells[_x][_y];
-            for (uint32_t i = 0; i < cell.size(); ++i) {
-                Entity &ent = simulation->get_ent(cell[i]);
-                if (ent.x + ent.radius < x - w) continue;
-                if (ent.x - ent.radius > x + w) continue;
-                if (ent.y + ent.radius < y - h) continue;
-                if (ent.y - ent.radius > y + h) continue;
-                if (seen_entities.contains(cell[i].id)) continue;
-                cb(simulation, ent);
-                seen_entities.insert(cell[i].id);
+            uint32_t size;
+            EntityID const *cell = _cell(_x, _y, size);
+            for (uint32_t i = 0; i < size; ++i) {
+                EntityID::id_type id = cell[i].id;
+                if (hot.x[id] + hot.radius[id] < x - w) continue;
+                if (hot.x[id] - hot.radius[id] > x + w) continue;
+                if (hot.y[id] + hot.radius[id] < y - h) continue;
+                if (hot.y[id] - hot.radius[id] > y + h) continue;
+                if (seen[id] == query_stamp) continue;
+                cb(simulation, simulation->get_ent(cell[i]));
+                HOT_COUNTERS_ONLY(++HotCounters::tick.query_results[caller];)
+                seen[id] = query_stamp;
             }
         }
     }
-}
\ No newline at end of file
+}
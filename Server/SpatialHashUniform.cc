@@ -3,70 +3,69 @@
 #include <Shared/Simulation.hh>
 #include <Shared/Entity.hh>
 
-SpatialHash::SpatialHash(Simulation *sim) : simulation(sim), width(1), height(1) {}
-
-void SpatialHash::refresh(uint32_t _width, uint32_t _height) {
-    DEBUG_ONLY(assert(_width <= ARENA_WIDTH && _height <= ARENA_HEIGHT));
-    width = div_round_up(_width, GRID_SIZE);
-    height = div_round_up(_height, GRID_SIZE);
-    for (uint32_t x = 0; x < MAX_GRID_X; ++x)
-        for (uint32_t y = 0; y < MAX_GRID_Y; ++y)
-            cells[x][y].clear();
-}
-
-void SpatialHash::insert(Entity const &ent) {
-    DEBUG_ONLY(assert(ent.has_component(kPhysics));)
+void SpatialHash::insert(EntityID const &id) {
+    EntityHotArrays const &hot = simulation->hot;
+    DEBUG_ONLY(assert(BIT_AT(hot.components[id.id], kPhysics));)
     //for the uniform grid to work, the max ent radius is GRID_SIZE/2
     //if larger entities are needed, either increase the GRID_SIZE
     //or use SpatialHashCanonical
-    DEBUG_ONLY(assert(ent.radius <= GRID_SIZE / 2);)
-    uint32_t x = fclamp(ent.x, 0, ARENA_WIDTH - 1) / GRID_SIZE;
-    uint32_t y = fclamp(ent.y, 0, ARENA_HEIGHT - 1) / GRID_SIZE;
-    cells[x][y].push_back(ent.id);
+    DEBUG_ONLY(assert(hot.radius[id.id] <= GRID_SIZE / 2);)
+    uint32_t x = fclamp(hot.x[id.id], 0, ARENA_WIDTH - 1) / GRID_SIZE;
+    uint32_t y = fclamp(hot.y[id.id], 0, ARENA_HEIGHT - 1) / GRID_SIZE;
+    _append(id, x, y);
 }
 
-void SpatialHash::collide(std::function<void(Simulation *, Entity &, Entity &)> on_collide) {
+void SpatialHash::collide(FunctionRef<void(Simulation *, EntityID const &, EntityID const &)> on_collide) {
+    sort();
     for (uint32_t x = 0; x < MAX_GRID_X; ++x) {
         for (uint32_t y = 0; y < MAX_GRID_Y; ++y) {
-            std::vector<EntityID> &cell = cells[x][y];
-            for (uint32_t i = 0; i < cell.size(); ++i) {
-                for (uint32_t j = i + 1; j < cell.size(); ++j) on_collide(simulation, simulation->get_ent(cell[i]), simulation->get_ent(cell[j]));
-                if (x < MAX_GRID_X - 1) {
-                    std::vector<EntityID> &cell2 = cells[x+1][y];
-                    for (uint32_t j = 0; j < cell2.size(); ++j) on_collide(simulation, simulation->get_ent(cell[i]), simulation->get_ent(cell2[j]));
-                    if (y > 0) {
-                        std::vector<EntityID> &cell2 = cells[x+1][y-1];
-                        for (uint32_t j = 0; j < cell2.size(); ++j) on_collide(simulation, simulation->get_ent(cell[i]), simulation->get_ent(cell2[j]));
-                    }
-                    if (y < MAX_GRID_Y - 1) {
-                        std::vector<EntityID> &cell2 = cells[x+1][y+1];
-                        for (uint32_t j = 0; j < cell2.size(); ++j) on_collide(simulation, simulation->get_ent(cell[i]), simulation->get_ent(cell2[j]));
-                    }
-                }
-                if (y < MAX_GRID_Y - 1) {
-                    std::vector<EntityID> &cell2 = cells[x][y+1];
-                    for (uint32_t j = 0; j < cell2.size(); ++j) on_collide(simulation, simulation->get_ent(cell[i]), simulation->get_ent(cell2[j]));
-                }
+            uint32_t size;
+            EntityID const *cell = _cell(x, y, size);
+            if (size == 0) continue;
+            //the neighbours to the right and below, so each pair of cells is visited once
+            uint32_t right_size = 0, up_right_size = 0, down_right_size = 0, down_size = 0;
+            EntityID const *right = nullptr, *up_right = nullptr, *down_right = nullptr, *down = nullptr;
+            if (x < MAX_GRID_X - 1) {
+                right = _cell(x + 1, y, right_size);
+                if (y > 0) up_right = _cell(x + 1, y - 1, up_right_size);
+                if (y < MAX_GRID_Y - 1) down_right = _cell(x + 1, y + 1, down_right_size);
+            }
+            if (y < MAX_GRID_Y - 1) down = _cell(x, y + 1, down_size);
+            for (uint32_t i = 0; i < size; ++i) {
+                for (uint32_t j = i + 1; j < size; ++j) on_collide(simulation, cell[i], cell[j]);
+                for (uint32_t j = 0; j < right_size; ++j) on_collide(simulation, cell[i], right[j]);
+                for (uint32_t j = 0; j < up_right_size; ++j) on_collide(simulation, cell[i], up_right[j]);
+                for (uint32_t j = 0; j < down_right_size; ++j) on_collide(simulation, cell[i], down_right[j]);
+                for (uint32_t j = 0; j < down_size; ++j) on_collide(simulation, cell[i], down[j]);
             }
         }
     }
 }
 
-void SpatialHash::query(float x, float y, float w, float h, std::function<void(Simulation *, Entity &)> cb) {
+void SpatialHash::query(float x, float y, float w, float h, FunctionRef<void(Simulation *, Entity &)> cb, uint8_t caller) {
+    sort();
     uint32_t sx = fclamp(x - w - GRID_SIZE / 2, 0, ARENA_WIDTH - 1) / GRID_SIZE;
     uint32_t sy = fclamp(y - h - GRID_SIZE / 2, 0, ARENA_HEIGHT - 1) / GRID_SIZE;
     uint32_t ex = fclamp(x + w + GRID_SIZE / 2, 0, ARENA_WIDTH - 1) / GRID_SIZE;
     uint32_t ey = fclamp(y + h + GRID_SIZE / 2, 0, ARENA_HEIGHT - 1) / GRID_SIZE;
+    HOT_COUNTERS_ONLY(
+        ++HotCounters::tick.query_calls[caller];
+        HotCounters::tick.query_cells[caller] += (ex - sx + 1) * (ey - sy + 1);
+    )
+    //the bounds check reads the packed arrays, only entities in range are touched
+    EntityHotArrays const &hot = simulation->hot;
     for (uint32_t _x = sx; _x <= ex; ++_x) {
         for (uint32_t _y = sy; _y <= ey; ++_y) {
-            std::vector<EntityID> &cell = cells[_x][_y];
-            for (uint32_t i = 0; i < cell.size(); ++i) {
-                Entity &ent = simulation->get_ent(cell[i]);
-                if (ent.x + ent.radius < x - w) continue;
-                if (ent.x - ent.radius > x + w) continue;
-                if (ent.y + ent.radius < y - h) continue;
-                if (ent.y - ent.radius > y + h) continue;
-                cb(simulation, ent);
+            uint32_t size;
+            EntityID const *cell = _cell(_x, _y, size);
+            for (uint32_t i = 0; i < size; ++i) {
+                EntityID::id_type id = cell[i].id;
+                if (hot.x[id] + hot.radius[id] < x - w) continue;
+                if (hot.x[id] - hot.radius[id] > x + w) continue;
+                if (hot.y[id] + hot.radius[id] < y - h) continue;
+                if (hot.y[id] - hot.radius[id] > y + h) continue;
+                cb(simulation, simulation->get_ent(cell[i]));
+                HOT_COUNTERS_ONLY(++HotCounters::tick.query_results[caller];)
             }
         }
     }
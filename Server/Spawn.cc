@@ -8,24 +8,112 @@
 #include <Shared/Simulation.hh>
 #include <Shared/StaticData.hh>
 
+#include <algorithm>
 #include <cmath>
 
-Entity &alloc_drop(Simulation *sim, PetalID::T drop_id) {
-    DEBUG_ONLY(assert(drop_id < PetalID::kNumPetals);)
-    PetalTracker::add_petal(sim, drop_id);
-    Entity &drop = sim->alloc_ent();
+//what every spawn of a mob, petal or drop starts with, built once and copied into each new entity
+//only fields that come out the same every time are in a prefab, so setting the rest afterwards marks
+//the same state bits building the entity field by field did
+//prefabs are entities of their own, attached to packed arrays that no simulation walks
+class Prefabs {
+    EntityHotArrays hot;
+    ReservedArray<Entity> ents;
+    static uint32_t const PETALS = MobID::kNumMobs;
+    static uint32_t const DROPS = PETALS + PetalID::kNumPetals;
+    static uint32_t const COUNT = DROPS + PetalID::kNumPetals;
+public:
+    Prefabs();
+    Entity const &mob(MobID::T id) const { return ents[id]; }
+    Entity const &petal(PetalID::T id) const { return ents[PETALS + id]; }
+    Entity const &drop(PetalID::T id) const { return ents[DROPS + id]; }
+};
+
+static void _mob_prefab(Entity &mob, MobID::T mob_id) {
+    struct MobData const &data = MOB_DATA[mob_id];
+    mob.add_component(kPhysics);
+    mob.friction() = DEFAULT_FRICTION;
+    if (mob_id == MobID::kAntHole)
+        BIT_SET(mob.flags(), EntityFlags::kNoFriendlyCollision);
+
+    mob.add_component(kRelations);
+
+    mob.add_component(kMob);
+    mob.set_mob_id(mob_id);
+
+    mob.add_component(kHealth);
+    mob.damage = data.damage;
+    mob.poison_damage = data.attributes.poison_damage;
+    mob.set_health_ratio(1);
+
+    mob.detection_radius = data.attributes.aggro_radius;
+    mob.score_reward = data.xp;
+
+    mob.add_component(kName);
+    mob.set_name(StringID::mob_name(mob_id));
+
+    if (mob_id == MobID::kDigger) {
+        mob.add_component(kFlower);
+        mob.set_color(ColorID::kGray);
+    }
+}
+
+static void _petal_prefab(Entity &petal, PetalID::T petal_id) {
+    struct PetalData const &petal_data = PETAL_DATA[petal_id];
+    petal.add_component(kPhysics);
+    petal.set_radius(petal_data.radius);
+    petal.mass() = petal_data.attributes.mass;
+    petal.friction() = DEFAULT_FRICTION * 1.5;
+    petal.add_component(kRelations);
+    petal.add_component(kPetal);
+    petal.set_petal_id(petal_id);
+    petal.add_component(kHealth);
+    petal.health = petal.max_health = petal_data.health;
+    petal.damage = petal_data.damage;
+    petal.set_health_ratio(1);
+    petal.poison_damage = petal_data.attributes.poison_damage;
+    if (petal_id == PetalID::kPincer) petal.slow_inflict = TPS * 1.5;
+    if (petal_id == PetalID::kBone) petal.armor = 4;
+}
+
+static void _drop_prefab(Entity &drop, PetalID::T drop_id) {
     drop.add_component(kPhysics);
     drop.set_radius(25);
-    drop.set_angle(frand() * 0.2 - 0.1);
-    drop.friction = 0.25;
+    drop.friction() = 0.25;
 
     drop.add_component(kRelations);
     drop.set_team(NULL_ENTITY);
 
     drop.add_component(kDrop);
     drop.set_drop_id(drop_id);
-    entity_set_despawn_tick(drop, 10 * (2 + PETAL_DATA[drop_id].rarity) * TPS);
-    drop.immunity_ticks = TPS / 3;
+}
+
+Prefabs::Prefabs() {
+    hot.reserve(COUNT);
+    hot.commit(COUNT);
+    ents.reserve(COUNT);
+    ents.commit(COUNT);
+    for (uint32_t i = 0; i < COUNT; ++i) ents[i].attach_hot(&hot, i);
+    for (MobID::T i = 0; i < MobID::kNumMobs; ++i) _mob_prefab(ents[i], i);
+    for (PetalID::T i = 0; i < PetalID::kNumPetals; ++i) {
+        _petal_prefab(ents[PETALS + i], i);
+        _drop_prefab(ents[DROPS + i], i);
+    }
+}
+
+//built by the first spawn, which is the game filling the map before its first tick
+static Prefabs const &_prefabs() {
+    static Prefabs const prefabs;
+    return prefabs;
+}
+
+Entity &alloc_drop(Simulation *sim, PetalID::T drop_id) {
+    DEBUG_ONLY(assert(drop_id < PetalID::kNumPetals);)
+    PetalTracker::add_petal(sim, drop_id);
+    Entity &drop = sim->alloc_ent(_prefabs().drop(drop_id));
+    drop.set_angle(frand() * 0.2 - 0.1);
+    entity_set_despawn_tick(sim, drop, 10 * (2 + PETAL_DATA[drop_id].rarity) * TPS);
+    entity_set_immunity(drop, TPS / 3);
+    sim->budget.track(drop, BudgetCategory::kDrop);
     return drop;
 }
 
@@ -33,58 +121,47 @@ static Entity &__alloc_mob(Simulation *sim, MobID::T mob_id, float x, float y, E
     DEBUG_ONLY(assert(mob_id < MobID::kNumMobs);)
     struct MobData const &data = MOB_DATA[mob_id];
     float seed = frand();
-    Entity &mob = sim->alloc_ent();
+    Entity &mob = sim->alloc_ent(_prefabs().mob(mob_id));
 
-    mob.add_component(kPhysics);
     mob.set_radius(data.radius.get_single(seed));
     mob.set_angle(frand() * 2 * M_PI);
     mob.set_x(x);
     mob.set_y(y);
-    mob.friction = DEFAULT_FRICTION;
-    mob.mass = (1 + mob.radius / BASE_FLOWER_RADIUS) * (data.attributes.stationary ? 10000 : 1);
-    if (mob_id == MobID::kAntHole)
-        BIT_SET(mob.flags, EntityFlags::kNoFriendlyCollision);
+    mob.mass() = (1 + mob.radius() / BASE_FLOWER_RADIUS) * (data.attributes.stationary ? 10000 : 1);
     if (team == NULL_ENTITY)
-        BIT_SET(mob.flags, EntityFlags::kHasCulling);
-        
-    mob.add_component(kRelations);
-    mob.set_team(team);
+        BIT_SET(mob.flags(), EntityFlags::kHasCulling);
+    if (mob_budget_category(team) != BudgetCategory::kPlayerOwned)
+        sim->budget.track(mob, mob_budget_category(team));
 
-    mob.add_component(kMob);
-    mob.set_mob_id(mob_id);
-
-    mob.add_component(kHealth);
+    mob.set_team(team);
     mob.health = mob.max_health = data.health.get_single(seed);
-    mob.damage = data.damage;
-    mob.poison_damage = data.attributes.poison_damage;
-    mob.set_health_ratio(1);
-
-    mob.detection_radius = data.attributes.aggro_radius;
-    mob.score_reward = data.xp;
-
-    mob.add_component(kName);
-    mob.set_name(data.name);
-
     mob.base_entity = mob.id;
-    if (mob_id == MobID::kDigger) {
-        mob.add_component(kFlower);
+    if (mob_id == MobID::kDigger)
         mob.set_angle(0);
-        mob.set_color(ColorID::kGray);
-    }
     return mob;
 }
 
+static MobID::T const ANT_HOLE_SPAWNS[] = { 
+    MobID::kBabyAnt, MobID::kBabyAnt, MobID::kBabyAnt, 
+    MobID::kWorkerAnt, MobID::kWorkerAnt, MobID::kSoldierAnt
+};
+
+uint32_t mob_entity_count(MobID::T mob_id) {
+    if (mob_id == MobID::kAntHole) return 1 + sizeof(ANT_HOLE_SPAWNS) / sizeof(ANT_HOLE_SPAWNS[0]);
+    return std::max<uint32_t>(MOB_DATA[mob_id].attributes.segments, 1);
+}
+
+uint8_t mob_budget_category(EntityID const &team) {
+    return team == NULL_ENTITY ? BudgetCategory::kZoneMob : BudgetCategory::kPlayerOwned;
+}
+
 Entity &alloc_mob(Simulation *sim, MobID::T mob_id, float x, float y, EntityID const team) {
     struct MobData const &data = MOB_DATA[mob_id];
     if (data.attributes.segments <= 1) {
         Entity &ent = __alloc_mob(sim, mob_id, x, y, team);
         if (mob_id == MobID::kAntHole) {
-            std::vector<MobID::T> const spawns = { 
-                MobID::kBabyAnt, MobID::kBabyAnt, MobID::kBabyAnt, 
-                MobID::kWorkerAnt, MobID::kWorkerAnt, MobID::kSoldierAnt
-            };
-            for (MobID::T mob_id : spawns) {
-                Vector rand = Vector::rand(ent.radius * 2);
+            for (MobID::T mob_id : ANT_HOLE_SPAWNS) {
+                Vector rand = Vector::rand(ent.radius() * 2);
                 Entity &ant = __alloc_mob(sim, mob_id, x + rand.x, y + rand.y, team);
                 ant.set_parent(ent.id);
             }
@@ -101,9 +178,9 @@ Entity &alloc_mob(Simulation *sim, MobID::T mob_id, float x, float y, EntityID c
             seg.add_component(kSegmented);
             seg.set_is_tail(1);
             seg.seg_head = curr->id;
-            seg.set_angle(curr->angle + frand() * 0.1 - 0.05);
-            seg.set_x(curr->x - (curr->radius + seg.radius) * cosf(seg.angle));
-            seg.set_y(curr->y - (curr->radius + seg.radius) * sinf(seg.angle));
+            seg.set_angle(curr->angle() + frand() * 0.1 - 0.05);
+            seg.set_x(curr->x() - (curr->radius() + seg.radius()) * cosf(seg.angle()));
+            seg.set_y(curr->y() - (curr->radius() + seg.radius()) * sinf(seg.angle()));
             curr = &seg;
         }
         return head;
@@ -115,8 +192,8 @@ Entity &alloc_player(Simulation *sim, EntityID const team) {
 
     player.add_component(kPhysics);
     player.set_radius(BASE_FLOWER_RADIUS);
-    player.friction = DEFAULT_FRICTION;
-    player.mass = 1;
+    player.friction() = DEFAULT_FRICTION;
+    player.mass() = 1;
 
     player.add_component(kFlower);
 
@@ -127,7 +204,7 @@ Entity &alloc_player(Simulation *sim, EntityID const team) {
     player.health = player.max_health = BASE_HEALTH;
     player.set_health_ratio(1);
     player.damage = BASE_BODY_DAMAGE;
-    player.immunity_ticks = 1.0 * TPS;
+    entity_set_immunity(player, 1.0 * TPS);
 
     player.add_component(kScore);
 
@@ -141,55 +218,45 @@ Entity &alloc_player(Simulation *sim, EntityID const team) {
 Entity &alloc_petal(Simulation *sim, PetalID::T petal_id, Entity const &parent) {
     DEBUG_ONLY(assert(petal_id < PetalID::kNumPetals);)
     struct PetalData const &petal_data = PETAL_DATA[petal_id];
-    Entity &petal = sim->alloc_ent();
-    petal.add_component(kPhysics);
-    petal.set_x(parent.x);
-    petal.set_y(parent.y);
-    petal.set_radius(petal_data.radius);
+    Entity &petal = sim->alloc_ent(_prefabs().petal(petal_id));
+    petal.set_x(parent.x());
+    petal.set_y(parent.y());
     if (petal_data.attributes.rotation_style == PetalAttributes::kPassiveRot)
         petal.set_angle(frand() * 2 * M_PI);
-    petal.mass = petal_data.attributes.mass;
-    petal.friction = DEFAULT_FRICTION * 1.5;
-    petal.add_component(kRelations);
     petal.set_parent(parent.id);
-    petal.set_team(parent.team);
-    petal.add_component(kPetal);
-    petal.set_petal_id(petal_id);
-    petal.add_component(kHealth);
-    petal.health = petal.max_health = petal_data.health;
-    petal.damage = petal_data.damage;
-    petal.set_health_ratio(1);
-    petal.poison_damage = petal_data.attributes.poison_damage;
-    if (petal_id == PetalID::kPincer) petal.slow_inflict = TPS * 1.5;
-    if (petal_id == PetalID::kBone) petal.armor = 4;
+    petal.set_team(parent.team());
 
     if (parent.id == NULL_ENTITY) petal.base_entity = petal.id;
     else petal.base_entity = parent.id;
+    //a flower's petals are its loadout, anything else shoots them
+    if (!parent.has_component(kFlower))
+        sim->budget.track(petal, BudgetCategory::kProjectile);
     return petal;
 }
 
 Entity &alloc_web(Simulation *sim, float radius, Entity const &parent) {
     Entity &web = sim->alloc_ent();
     web.add_component(kPhysics);
-    web.set_x(parent.x);
-    web.set_y(parent.y);
+    web.set_x(parent.x());
+    web.set_y(parent.y());
     web.set_angle(frand() * 2 * M_PI);
     web.set_radius(radius);
-    web.mass = 1.0;
-    web.friction = 1.0;
+    web.mass() = 1.0;
+    web.friction() = 1.0;
     web.add_component(kRelations);
-    web.set_team(parent.team);
+    web.set_team(parent.team());
     web.set_parent(parent.id);
     web.add_component(kWeb);
-    entity_set_despawn_tick(web, 10 * TPS);
+    entity_set_despawn_tick(sim, web, 10 * TPS);
+    sim->budget.track(web, BudgetCategory::kProjectile);
     return web;
 }
 
 void player_spawn(Simulation *sim, Entity &camera, Entity &player) {
     camera.set_player(player.id);
     player.set_parent(camera.id);
-    player.set_color(camera.color);
-    uint32_t power = Map::difficulty_at_level(camera.respawn_level);
+    player.set_color(camera.color());
+    uint32_t power = Map::difficulty_at_level(camera.respawn_level());
     ZoneDefinition const &zone = MAP[Map::get_suitable_difficulty_zone(power)];
     float spawn_x = lerp(zone.left, zone.right, frand());
     float spawn_y = lerp(zone.top, zone.bottom, frand());
@@ -197,19 +264,19 @@ void player_spawn(Simulation *sim, Entity &camera, Entity &player) {
     camera.set_camera_y(spawn_y);
     player.set_x(spawn_x);
     player.set_y(spawn_y);
-    player.set_score(level_to_score(camera.respawn_level));
-    player.set_loadout_count(loadout_slots_at_level(camera.respawn_level));
-    player.health = player.max_health = hp_at_level(camera.respawn_level);
-    for (uint32_t i = 0; i < player.loadout_count; ++i) {
-        PetalID::T id = camera.inventory[i];
-        LoadoutSlot &slot = player.loadout[i];
+    player.set_score(level_to_score(camera.respawn_level()));
+    player.set_loadout_count(loadout_slots_at_level(camera.respawn_level()));
+    player.health = player.max_health = hp_at_level(camera.respawn_level());
+    for (uint32_t i = 0; i < player.loadout_count(); ++i) {
+        PetalID::T id = camera.inventory(i);
+        LoadoutSlot &slot = player.loadout(i);
         player.set_loadout_ids(i, id);
         slot.update_id(sim, id);
         slot.force_reload();
     }
 
-    for (uint32_t i = player.loadout_count; i < player.loadout_count + MAX_SLOT_COUNT; ++i)
-        player.set_loadout_ids(i, camera.inventory[i]);
+    for (uint32_t i = player.loadout_count(); i < player.loadout_count() + MAX_SLOT_COUNT; ++i)
+        player.set_loadout_ids(i, camera.inventory(i));
 
     //peaceful transfer, no petal tracking needed
     for (uint32_t i = 0; i < MAX_SLOT_COUNT * 2; ++i)
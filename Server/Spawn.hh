@@ -10,4 +10,9 @@ Entity &alloc_player(Simulation *, EntityID const);
 Entity &alloc_petal(Simulation *, PetalID::T, Entity const &);
 Entity &alloc_web(Simulation *, float, Entity const &);
 
-void player_spawn(Simulation *, Entity &, Entity &);
\ No newline at end of file
+void player_spawn(Simulation *, Entity &, Entity &);
+
+//how many entities alloc_mob makes for one mob
+uint32_t mob_entity_count(MobID::T);
+//mobs without a team are wild and count against the zone mobs' budget
+uint8_t mob_budget_category(EntityID const &);
\ No newline at end of file
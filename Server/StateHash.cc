@@ -0,0 +1,155 @@
+#if defined(DEBUG) || defined(BENCHMARK)
+#include <Server/StateHash.hh>
+
+#include <Shared/Entity.hh>
+#include <Shared/Simulation.hh>
+#include <Shared/StringTable.hh>
+
+#include <cstring>
+#include <string_view>
+#include <type_traits>
+
+#ifdef DEBUG
+uint8_t StateHash::enabled = 1;
+#else
+uint8_t StateHash::enabled = 0;
+#endif
+uint64_t StateHash::last = 0;
+std::FILE *StateHash::dump_to = nullptr;
+
+static void _mix(uint64_t &h, uint64_t v) {
+    h ^= v + 0x9e3779b97f4a7c15ull + (h << 6) + (h >> 2);
+}
+
+//exact bit patterns, so even -0 and 0 or the last ulp of a float count as a divergence
+template<typename T>
+static uint64_t _value(T const &v) {
+    static_assert(std::is_arithmetic_v<T>);
+    uint64_t ret = 0;
+    std::memcpy(&ret, &v, sizeof(T));
+    return ret;
+}
+
+static uint64_t _value(EntityID const &id) {
+    return (uint64_t) id.id << 8 | id.hash;
+}
+
+//the string and not the handle, handles depend on what else has been interned
+static uint64_t _value(StringID const &str) {
+    std::string_view text = StringTable::get(str);
+    uint64_t h = text.size();
+    for (char c : text) _mix(h, c);
+    return h;
+}
+
+static uint64_t _value(Vector const &v) {
+    uint64_t h = _value(v.x);
+    _mix(h, _value(v.y));
+    return h;
+}
+
+static uint64_t _value(PoisonDamage const &p) {
+    uint64_t h = _value(p.damage);
+    _mix(h, _value(p.time));
+    return h;
+}
+
+static uint64_t _value(LoadoutSlot const &slot) {
+    uint64_t h = slot.get_petal_id();
+    _mix(h, slot.already_spawned);
+    for (uint32_t i = 0; i < MAX_PETALS_IN_CLUMP; ++i) {
+        _mix(h, _value(slot.petals[i].ent_id));
+        _mix(h, slot.petals[i].reload);
+    }
+    return h;
+}
+
+static uint64_t _value(circ_arr_t const &arr) {
+    uint64_t h = arr.size();
+    for (uint32_t i = 0; i < arr.size(); ++i) _mix(h, arr[i]);
+    return h;
+}
+
+//built at startup, a function static would be built inside the first hashed tick and allocate there
+template<typename T>
+static T const EMPTY_FIELDS = [](){ T t; t.reset(); return t; }();
+
+template<typename T>
+static T const &_empty() {
+    return EMPTY_FIELDS<T>;
+}
+
+static void _field(uint64_t &h, Entity const &ent, char const *name, int32_t index, uint64_t value) {
+    _mix(h, value);
+    if (StateHash::dump_to == nullptr) return;
+    if (index < 0) std::fprintf(StateHash::dump_to, "%u %s %016llx\n", ent.id.id, name, (unsigned long long) value);
+    else std::fprintf(StateHash::dump_to, "%u %s[%d] %016llx\n", ent.id.id, name, index, (unsigned long long) value);
+}
+
+static uint64_t _entity(Entity const &ent) {
+    uint64_t h = 0;
+    _field(h, ent, "id", -1, _value(ent.id));
+    _field(h, ent, "lifetime", -1, ent.lifetime());
+    _field(h, ent, "pending_delete", -1, ent.pending_delete());
+    uint32_t components = 0;
+    for (uint32_t i = 0; i < kComponentCount; ++i)
+        if (ent.has_component(i)) components |= 1 << i;
+    _field(h, ent, "components", -1, components);
+    //a chunked component the entity doesn't have hashes as its reset state, same as an inline one
+    #define COMPONENT(name) Entity const &name##_fields = ent;
+    PER_INLINE_COMPONENT
+    #undef COMPONENT
+    #define COMPONENT(name) name##Ref const name##_fields = ent.name##_data();
+    PER_HOT_COMPONENT
+    #undef COMPONENT
+    #define COMPONENT(name) name##Data const &name##_fields = ent.has_component(k##name) ? ent.name##_data() : _empty<name##Data>();
+    PER_CHUNKED_COMPONENT
+    #undef COMPONENT
+    #define SINGLE(component, name, type) _field(h, ent, #name, -1, _value(component##_fields.name));
+    #define MULTIPLE(component, name, type, amt) \
+        for (uint32_t n = 0; n < amt; ++n) _field(h, ent, #name, n, _value(component##_fields.name[n]));
+    PERFIELD
+    #undef SINGLE
+    #undef MULTIPLE
+    #define SINGLE(name, type, reset) _field(h, ent, #name, -1, _value(ent.name));
+    #define MULTIPLE(name, type, amt, reset) \
+        for (uint32_t n = 0; n < amt; ++n) _field(h, ent, #name, n, _value(ent.name[n]));
+    #define HOT_SINGLE(name, type, reset) _field(h, ent, #name, -1, _value(ent.name()));
+    PER_EXTRA_FIELD
+    #undef SINGLE
+    #undef MULTIPLE
+    #undef HOT_SINGLE
+    #define EXTRA_SINGLE(component, name, type, reset) _field(h, ent, #name, -1, _value(component##_fields.name));
+    #define EXTRA_MULTIPLE(component, name, type, amt, reset) \
+        for (uint32_t n = 0; n < amt; ++n) _field(h, ent, #name, n, _value(component##_fields.name[n]));
+    #define COMPONENT(name) EXTRA_FIELDS_##name
+    PER_CHUNKED_COMPONENT
+    #undef COMPONENT
+    #undef EXTRA_SINGLE
+    #undef EXTRA_MULTIPLE
+    return h;
+}
+
+static void _counter(uint64_t &h, char const *name, int32_t index, uint64_t value) {
+    _mix(h, value);
+    if (StateHash::dump_to == nullptr) return;
+    std::fprintf(StateHash::dump_to, "sim %s[%d] %016llx\n", name, index, (unsigned long long) value);
+}
+
+uint64_t StateHash::compute(Simulation *sim) {
+    uint64_t h = 0;
+    //entities in id order, which is the order pre_tick lists them in
+    sim->for_each_entity([&](Simulation *sim, Entity &ent) {
+        _mix(h, _entity(ent));
+    });
+    for (uint32_t i = 0; i < PetalID::kNumPetals; ++i)
+        _counter(h, "petal_count_tracker", i, sim->petal_count_tracker[i]);
+    for (uint32_t i = 0; i < MAP.size(); ++i)
+        _counter(h, "zone_mob_counts", i, sim->zone_mob_counts[i]);
+    //peek at the rng without advancing it
+    Rng rng = sim->rng;
+    _counter(h, "rng", 0, rng.next());
+    dump_to = nullptr;
+    return h;
+}
+#endif
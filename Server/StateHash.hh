@@ -0,0 +1,24 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+
+#if defined(DEBUG) || defined(BENCHMARK)
+#define STATE_HASH_ONLY(...) __VA_ARGS__
+#else
+#define STATE_HASH_ONLY(...)
+#endif
+
+class Simulation;
+
+//canonical hash of every live entity's protocol and server-only fields, plus the simulation's
+//own counters and rng, taken at the start of each tick (after pre_tick) in DEBUG and BENCHMARK builds
+//two builds fed the same seed and messages should agree on it tick for tick
+namespace StateHash {
+    //on by default in DEBUG builds, gardn-replay turns it on when asked for hashes
+    extern uint8_t enabled;
+    extern uint64_t last;
+    //if set, the next compute also writes one line per field: <entity id> <field> <value hash>
+    extern std::FILE *dump_to;
+    uint64_t compute(Simulation *);
+};
@@ -0,0 +1,43 @@
+#include <Server/TickArena.hh>
+
+#include <Shared/Entity.hh>
+#include <Shared/ReservedArray.hh>
+
+//the largest users take a few ids or pointers per entity, one at a time
+//reserved for the largest cap, only what has been used is ever committed
+static size_t const BYTES_PER_ENTITY = 64;
+
+static ReservedArray<uint8_t> arena;
+static size_t offset = 0;
+static size_t high_water = 0;
+
+void *TickArena::alloc(size_t size, size_t align) {
+    if (arena.capacity() == 0) arena.reserve(BYTES_PER_ENTITY * MAX_ENTITY_CAP);
+    size_t start = (offset + align - 1) & ~(align - 1);
+    //running out means a scratch user grew past what a tick is allowed, not that the heap should take over
+    assert(start + size <= arena.capacity());
+    offset = start + size;
+    if (offset > high_water) {
+        high_water = offset;
+        arena.commit(high_water);
+    }
+    return arena.data() + start;
+}
+
+void TickArena::reset() {
+    offset = 0;
+}
+
+size_t TickArena::used() {
+    return offset;
+}
+
+size_t TickArena::peak() {
+    return high_water;
+}
+
+TickArena::Scope::Scope() : mark(offset) {}
+
+TickArena::Scope::~Scope() {
+    offset = mark;
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+//scratch memory for work that only lives through one tick, handed out by bumping an offset into a
+//block reserved up front, so it costs nothing to allocate and nothing is ever given back to the heap
+//everything in it is dropped when the next tick starts
+namespace TickArena {
+    void *alloc(size_t, size_t);
+    void reset();
+    size_t used();
+    //high water mark since startup
+    size_t peak();
+
+    //rewinds the arena on the way out, for scratch that only lives through one call
+    class Scope {
+        size_t mark;
+    public:
+        Scope();
+        ~Scope();
+    };
+};
+
+//fixed capacity array whose storage comes from the tick arena, values are never destroyed
+template<typename T>
+class TickArray {
+    static_assert(std::is_trivially_destructible_v<T>);
+    T *values;
+    uint32_t length;
+    uint32_t capacity;
+public:
+    TickArray(uint32_t cap) : values(static_cast<T *>(TickArena::alloc(cap * sizeof(T), alignof(T)))), length(0), capacity(cap) {}
+    TickArray(TickArray const &) = delete;
+    TickArray &operator=(TickArray const &) = delete;
+    T &operator[](uint32_t at) { return values[at]; }
+    T const &operator[](uint32_t at) const { return values[at]; }
+    uint32_t size() const { return length; }
+    void push(T const &val) { assert(length < capacity); values[length++] = val; }
+    T pop() { assert(length > 0); return values[--length]; }
+    T &back() { return values[length - 1]; }
+    void clear() { length = 0; }
+    T *begin() { return values; }
+    T *end() { return values + length; }
+    T const *begin() const { return values; }
+    T const *end() const { return values + length; }
+};
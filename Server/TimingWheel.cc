@@ -0,0 +1,89 @@
+#include <Server/TimingWheel.hh>
+
+TimingWheel::TimingWheel() : now(0) {
+    for (uint32_t i = 0; i < LEVELS * BUCKETS; ++i) heads[i] = 0;
+}
+
+void TimingWheel::reserve(uint32_t count) {
+    nodes.reserve(count * EntityTimer::kNumTimers);
+    for (uint32_t i = 0; i < LEVELS * BUCKETS; ++i) heads[i] = 0;
+}
+
+void TimingWheel::commit(uint32_t count) {
+    nodes.commit(count * EntityTimer::kNumTimers);
+}
+
+void TimingWheel::clear() {
+    for (uint32_t i = 0; i < nodes.size(); ++i) nodes[i].bucket = 0;
+    for (uint32_t i = 0; i < LEVELS * BUCKETS; ++i) heads[i] = 0;
+    now = 0;
+}
+
+//the lowest level whose span reaches the due countdown, anything past the top level waits in its
+//farthest bucket and is placed again when that bucket comes up
+void TimingWheel::_link(uint32_t n) {
+    Node &node = nodes[n];
+    uint64_t ahead = node.due - now;
+    uint32_t level = 0;
+    while (level + 1 < LEVELS && ahead >= (uint64_t) 1 << (BUCKET_BITS * (level + 1))) ++level;
+    uint64_t due = node.due;
+    uint64_t span = (uint64_t) 1 << (BUCKET_BITS * LEVELS);
+    if (ahead >= span) due = now + span - 1;
+    uint32_t bucket = level * BUCKETS + ((due >> (BUCKET_BITS * level)) & (BUCKETS - 1));
+    node.bucket = bucket + 1;
+    node.prev = 0;
+    node.next = heads[bucket];
+    if (heads[bucket] != 0) nodes[heads[bucket] - 1].prev = n + 1;
+    heads[bucket] = n + 1;
+}
+
+void TimingWheel::_unlink(uint32_t n) {
+    Node &node = nodes[n];
+    if (node.prev != 0) nodes[node.prev - 1].next = node.next;
+    else heads[node.bucket - 1] = node.next;
+    if (node.next != 0) nodes[node.next - 1].prev = node.prev;
+    node.bucket = 0;
+}
+
+//empties a bucket and places its timers again, which puts each one a level lower
+void TimingWheel::_cascade(uint32_t bucket) {
+    uint32_t n = heads[bucket];
+    heads[bucket] = 0;
+    while (n != 0) {
+        uint32_t next = nodes[n - 1].next;
+        _link(n - 1);
+        n = next;
+    }
+}
+
+void TimingWheel::schedule(uint8_t timer, EntityID::id_type id, uint32_t due) {
+    uint32_t n = id * EntityTimer::kNumTimers + timer;
+    if (nodes[n].bucket != 0) _unlink(n);
+    nodes[n].due = due > now ? due : now + 1;
+    _link(n);
+}
+
+void TimingWheel::cancel(uint8_t timer, EntityID::id_type id) {
+    uint32_t n = id * EntityTimer::kNumTimers + timer;
+    if (nodes[n].bucket != 0) _unlink(n);
+}
+
+uint8_t TimingWheel::scheduled(uint8_t timer, EntityID::id_type id) const {
+    return nodes[id * EntityTimer::kNumTimers + timer].bucket != 0;
+}
+
+void TimingWheel::advance(uint32_t to, FunctionRef<void(uint8_t, EntityID::id_type)> cb) {
+    while (now < to) {
+        ++now;
+        for (uint32_t level = LEVELS - 1; level > 0; --level) {
+            if ((now & (((uint32_t) 1 << (BUCKET_BITS * level)) - 1)) != 0) continue;
+            _cascade(level * BUCKETS + ((now >> (BUCKET_BITS * level)) & (BUCKETS - 1)));
+        }
+        uint32_t bucket = now & (BUCKETS - 1);
+        while (heads[bucket] != 0) {
+            uint32_t n = heads[bucket] - 1;
+            _unlink(n);
+            cb(n % EntityTimer::kNumTimers, n / EntityTimer::kNumTimers);
+        }
+    }
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <Shared/Entity.hh>
+#include <Shared/Helpers.hh>
+#include <Shared/ReservedArray.hh>
+
+#include <cstdint>
+
+//what an entity slot can have scheduled, at most one of each at a time
+namespace EntityTimer {
+    enum : uint8_t {
+        kDespawn,
+        //the end of the death animation, when the slot is freed
+        kDeletion,
+        kNumTimers
+    };
+};
+
+//expirations keyed by the post_tick countdown they are due at, so an entity waiting on a timer costs
+//nothing until it fires
+//the wheel has a few levels of buckets, each level a coarser step than the one below, and a bucket
+//moves down a level as its time comes up, so scheduling and firing are constant time however far off
+//buckets are lists threaded through one node per slot and timer, so nothing is allocated and
+//scheduling a timer again just moves its node
+class TimingWheel {
+    static uint32_t const BUCKET_BITS = 6;
+    static uint32_t const BUCKETS = 1 << BUCKET_BITS;
+    static uint32_t const LEVELS = 4;
+    struct Node {
+        uint32_t due;
+        //the rest are one past an index, 0 for none, so freshly committed nodes are unscheduled
+        uint32_t prev;
+        uint32_t next;
+        uint32_t bucket;
+    };
+    ReservedArray<Node> nodes;
+    uint32_t heads[LEVELS * BUCKETS];
+    uint32_t now;
+    void _link(uint32_t);
+    void _unlink(uint32_t);
+    void _cascade(uint32_t);
+public:
+    TimingWheel();
+    void reserve(uint32_t);
+    void commit(uint32_t);
+    void clear();
+    //a countdown at or before the last one advanced to fires on the next
+    void schedule(uint8_t, EntityID::id_type, uint32_t);
+    void cancel(uint8_t, EntityID::id_type);
+    uint8_t scheduled(uint8_t, EntityID::id_type) const;
+    //steps the wheel to the countdown, calling back with the timer and slot of everything due on the way
+    void advance(uint32_t, FunctionRef<void(uint8_t, EntityID::id_type)>);
+};
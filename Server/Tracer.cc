@@ -0,0 +1,121 @@
+#ifdef TRACE
+#include <Server/Tracer.hh>
+
+#include <Server/Profiler.hh>
+
+#include <Shared/StaticData.hh>
+
+#include <atomic>
+#include <csignal>
+#include <cstdio>
+#include <ctime>
+#include <iostream>
+
+static uint32_t const TRACE_CAPACITY = 1 << 17; //power of two
+static uint32_t const TRACE_MAX_THREADS = 16;
+static uint32_t const TRACE_WINDOW_TICKS = 2 * TPS;
+static uint64_t const TRACE_SPIKE_MS = 25;
+//don't write a file every tick while the server is struggling
+static uint64_t const TRACE_COOLDOWN_MS = 10000;
+
+struct TraceEvent {
+    uint64_t start;
+    uint64_t end;
+    uint32_t arg;
+    uint8_t section;
+};
+
+struct TraceBuffer {
+    uint32_t tid;
+    std::atomic<uint32_t> head;
+    TraceEvent events[TRACE_CAPACITY];
+};
+
+static TraceBuffer *buffers[TRACE_MAX_THREADS] = {nullptr};
+static std::atomic<uint32_t> buffer_count = 0;
+static thread_local TraceBuffer *local_buffer = nullptr;
+static volatile std::sig_atomic_t capture_requested = 0;
+static uint64_t last_tick_ns = 0;
+static uint64_t last_capture = 0;
+
+static TraceBuffer *_get_buffer() {
+    if (local_buffer != nullptr) return local_buffer;
+    uint32_t idx = buffer_count.fetch_add(1, std::memory_order_relaxed);
+    if (idx >= TRACE_MAX_THREADS) return nullptr;
+    local_buffer = new TraceBuffer;
+    local_buffer->tid = idx + 1;
+    local_buffer->head.store(0, std::memory_order_relaxed);
+    buffers[idx] = local_buffer;
+    return local_buffer;
+}
+
+void Tracer::record(uint8_t section, uint32_t arg, uint64_t start, uint64_t end) {
+    if (section == ProfileSection::kTick) last_tick_ns = end - start;
+    TraceBuffer *buffer = _get_buffer();
+    if (buffer == nullptr) return;
+    uint32_t head = buffer->head.load(std::memory_order_relaxed);
+    buffer->events[head & (TRACE_CAPACITY - 1)] = { start, end, arg, section };
+    buffer->head.store(head + 1, std::memory_order_release);
+}
+
+static void _write_event(std::FILE *file, uint32_t tid, TraceEvent const &event, uint8_t &first) {
+    std::fprintf(file, "%s\n{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f",
+        first ? "" : ",", Profiler::NAMES[event.section], tid, event.start / 1e3, (event.end - event.start) / 1e3);
+    if (event.section == ProfileSection::kUpdateClient || event.section == ProfileSection::kMessage)
+        std::fprintf(file, ",\"args\":{\"camera\":%u}", event.arg);
+    std::fprintf(file, "}");
+    first = 0;
+}
+
+static void _capture(char const *reason) {
+    uint64_t now = Profiler::now();
+    uint64_t window_start = now - (uint64_t) TRACE_WINDOW_TICKS * 1000000000 / TPS;
+    char path[64];
+    std::snprintf(path, sizeof(path), "trace-%lld.json", (long long) std::time(nullptr));
+    std::FILE *file = std::fopen(path, "w");
+    if (file == nullptr) {
+        std::perror("trace capture");
+        return;
+    }
+    std::fprintf(file, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[");
+    uint8_t first = 1;
+    uint32_t count = buffer_count.load(std::memory_order_relaxed);
+    if (count > TRACE_MAX_THREADS) count = TRACE_MAX_THREADS;
+    for (uint32_t i = 0; i < count; ++i) {
+        TraceBuffer *buffer = buffers[i];
+        if (buffer == nullptr) continue;
+        uint32_t head = buffer->head.load(std::memory_order_acquire);
+        uint32_t tail = head > TRACE_CAPACITY ? head - TRACE_CAPACITY : 0;
+        for (uint32_t at = tail; at != head; ++at) {
+            TraceEvent const &event = buffer->events[at & (TRACE_CAPACITY - 1)];
+            if (event.start < window_start) continue;
+            _write_event(file, buffer->tid, event, first);
+        }
+    }
+    std::fprintf(file, "\n]}\n");
+    std::fclose(file);
+    std::cout << "wrote " << path << " (" << reason << ")\n";
+}
+
+static void _on_signal(int) {
+    capture_requested = 1;
+}
+
+void Tracer::install_signal_handlers() {
+    std::signal(SIGURG, _on_signal);
+}
+
+void Tracer::end_tick() {
+    uint64_t now = Profiler::now();
+    if (capture_requested) {
+        capture_requested = 0;
+        _capture("requested");
+        last_capture = now;
+        return;
+    }
+    if (last_tick_ns < TRACE_SPIKE_MS * 1000000) return;
+    if (last_capture != 0 && now - last_capture < TRACE_COOLDOWN_MS * 1000000) return;
+    _capture("spike");
+    last_capture = now;
+}
+#endif
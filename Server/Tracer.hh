@@ -0,0 +1,20 @@
+#pragma once
+
+#include <cstdint>
+
+#ifdef TRACE
+#define TRACE_ONLY(...) __VA_ARGS__
+#else
+#define TRACE_ONLY(...)
+#endif
+
+//chrome trace-event capture of profiled scopes, compiled in with -DTRACE
+//every thread appends to its own ring, the last TRACE_WINDOW_TICKS ticks are written out
+//as trace-<time>.json (open in chrome://tracing or ui.perfetto.dev) when a tick spikes past
+//TRACE_SPIKE_MS or on SIGURG
+namespace Tracer {
+    void record(uint8_t, uint32_t, uint64_t, uint64_t);
+    void install_signal_handlers();
+    //checks for a spike or a requested capture, call once the tick is over
+    void end_tick();
+};
@@ -0,0 +1,715 @@
+#ifdef URING_SERVER
+#include <Server/Server.hh>
+
+#include <Server/Client.hh>
+#include <Server/Metrics.hh>
+#include <Shared/Config.hh>
+
+#include <linux/io_uring.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <openssl/evp.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <csignal>
+#include <cstring>
+#include <ctime>
+#include <iostream>
+
+//plain tcp websocket server on io_uring, tls is expected to be terminated by a local proxy
+//accepts and recvs are multishot, recvs land in kernel-selected provided buffers
+//every client owns a slice of one registered send region, packets are framed straight into it
+//and the whole fan-out is flushed with a single io_uring_enter per tick
+
+static uint32_t const RING_ENTRIES = 4096;
+static uint32_t const MAX_CONNECTIONS = 256;
+static uint32_t const RECV_BUFFER_COUNT = 512;
+static uint32_t const RECV_BUFFER_LEN = 2048;
+static uint32_t const MAX_REQUEST_LEN = 4096;
+static uint32_t const MAX_PAYLOAD_LEN = 128;
+static size_t const SEND_BUFFER_LEN = 2 * MAX_PACKET_LEN;
+//stop sending updates above the high mark, catch the client up once fully drained
+static size_t const CONGESTION_HIGH_WATER = SEND_BUFFER_LEN / 2;
+static uint32_t const IDLE_TIMEOUT = 15 * TPS;
+static uint16_t const RECV_BUFFER_GROUP = 0;
+
+namespace UserData {
+    enum : uint8_t {
+        kAccept,
+        kRecv,
+        kWrite,
+        kTimeout,
+        kProvide
+    };
+};
+
+struct Connection {
+    int fd = -1;
+    uint32_t generation = 0;
+    WebSocket *ws = nullptr;
+    uint8_t upgraded = 0;
+    uint8_t closing = 0;
+    uint8_t recv_armed = 0;
+    uint8_t write_in_flight = 0;
+    uint8_t flush_queued = 0;
+    uint8_t pinged = 0;
+    //its input is being parsed, a close that lands meanwhile is finished once parsing stops
+    uint8_t in_recv = 0;
+    //accepted on the loopback metrics listener, plain http
+    uint8_t metrics = 0;
+    //the tick input last arrived, or the tick it started flushing to close
+    uint32_t last_recv = 0;
+    uint32_t in_len = 0;
+    uint8_t in[MAX_REQUEST_LEN];
+    uint8_t *out = nullptr;
+    size_t out_head = 0;
+    size_t out_tail = 0;
+};
+
+struct Ring {
+    int fd = -1;
+    uint32_t entries = 0;
+    uint32_t *sq_head;
+    uint32_t *sq_tail;
+    uint32_t *sq_mask;
+    uint32_t *sq_array;
+    uint32_t sq_local_tail = 0;
+    uint32_t *cq_head;
+    uint32_t *cq_tail;
+    uint32_t *cq_mask;
+    struct io_uring_sqe *sqes;
+    struct io_uring_cqe *cqes;
+};
+
+static Ring ring;
+static Connection CONNECTIONS[MAX_CONNECTIONS];
+static StaticArray<uint32_t, MAX_CONNECTIONS> free_connections;
+static StaticArray<uint32_t, MAX_CONNECTIONS> pending_flush;
+static uint8_t *recv_buffers = nullptr;
+static uint8_t *send_region = nullptr;
+static uint8_t send_region_registered = 0;
+static int listen_fd = -1;
+static int metrics_fd = -1;
+static uint32_t tick_count = 0;
+static struct __kernel_timespec next_tick = {};
+
+static uint64_t _pack_user_data(uint8_t type, uint32_t idx, uint32_t generation) {
+    return (uint64_t(type) << 56) | (uint64_t(generation) << 16) | idx;
+}
+
+static int _ring_enter(uint32_t to_submit, uint32_t wait) {
+    int ret = syscall(__NR_io_uring_enter, ring.fd, to_submit, wait, wait ? IORING_ENTER_GETEVENTS : 0, nullptr, 0);
+    ++Server::transport_stats.syscalls;
+    return ret;
+}
+
+static int _ring_submit(uint32_t wait) {
+    uint32_t to_submit = ring.sq_local_tail - *ring.sq_tail;
+    __atomic_store_n(ring.sq_tail, ring.sq_local_tail, __ATOMIC_RELEASE);
+    int ret;
+    do ret = _ring_enter(to_submit, wait);
+    while (ret < 0 && errno == EINTR);
+    return ret;
+}
+
+static struct io_uring_sqe *_get_sqe() {
+    uint32_t head = __atomic_load_n(ring.sq_head, __ATOMIC_ACQUIRE);
+    if (ring.sq_local_tail - head >= ring.entries) {
+        _ring_submit(0);
+        head = __atomic_load_n(ring.sq_head, __ATOMIC_ACQUIRE);
+        assert(ring.sq_local_tail - head < ring.entries);
+    }
+    uint32_t idx = ring.sq_local_tail & *ring.sq_mask;
+    struct io_uring_sqe *sqe = &ring.sqes[idx];
+    std::memset(sqe, 0, sizeof(struct io_uring_sqe));
+    ring.sq_array[idx] = idx;
+    ++ring.sq_local_tail;
+    return sqe;
+}
+
+static void _ring_init() {
+    struct io_uring_params params;
+    std::memset(&params, 0, sizeof(params));
+    params.flags = IORING_SETUP_SINGLE_ISSUER | IORING_SETUP_COOP_TASKRUN;
+    ring.fd = syscall(__NR_io_uring_setup, RING_ENTRIES, &params);
+    if (ring.fd < 0) {
+        //older kernels reject the taskrun hints
+        std::memset(&params, 0, sizeof(params));
+        ring.fd = syscall(__NR_io_uring_setup, RING_ENTRIES, &params);
+    }
+    if (ring.fd < 0) {
+        std::perror("io_uring_setup");
+        std::exit(1);
+    }
+    ring.entries = params.sq_entries;
+    size_t sq_size = params.sq_off.array + params.sq_entries * sizeof(uint32_t);
+    size_t cq_size = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+    if (params.features & IORING_FEAT_SINGLE_MMAP)
+        sq_size = cq_size = std::max(sq_size, cq_size);
+    uint8_t *sq_ptr = (uint8_t *) mmap(nullptr, sq_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring.fd, IORING_OFF_SQ_RING);
+    uint8_t *cq_ptr = sq_ptr;
+    if (!(params.features & IORING_FEAT_SINGLE_MMAP))
+        cq_ptr = (uint8_t *) mmap(nullptr, cq_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring.fd, IORING_OFF_CQ_RING);
+    void *sqes = mmap(nullptr, params.sq_entries * sizeof(struct io_uring_sqe), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring.fd, IORING_OFF_SQES);
+    if (sq_ptr == MAP_FAILED || cq_ptr == MAP_FAILED || sqes == MAP_FAILED) {
+        std::perror("io_uring mmap");
+        std::exit(1);
+    }
+    ring.sq_head = (uint32_t *) (sq_ptr + params.sq_off.head);
+    ring.sq_tail = (uint32_t *) (sq_ptr + params.sq_off.tail);
+    ring.sq_mask = (uint32_t *) (sq_ptr + params.sq_off.ring_mask);
+    ring.sq_array = (uint32_t *) (sq_ptr + params.sq_off.array);
+    ring.sq_local_tail = *ring.sq_tail;
+    ring.cq_head = (uint32_t *) (cq_ptr + params.cq_off.head);
+    ring.cq_tail = (uint32_t *) (cq_ptr + params.cq_off.tail);
+    ring.cq_mask = (uint32_t *) (cq_ptr + params.cq_off.ring_mask);
+    ring.cqes = (struct io_uring_cqe *) (cq_ptr + params.cq_off.cqes);
+    ring.sqes = (struct io_uring_sqe *) sqes;
+
+    //kernel-selected receive buffers for multishot recv, handed over once up front
+    recv_buffers = (uint8_t *) mmap(nullptr, RECV_BUFFER_COUNT * RECV_BUFFER_LEN, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    struct io_uring_sqe *sqe = _get_sqe();
+    sqe->opcode = IORING_OP_PROVIDE_BUFFERS;
+    sqe->fd = RECV_BUFFER_COUNT;
+    sqe->addr = (uint64_t) recv_buffers;
+    sqe->len = RECV_BUFFER_LEN;
+    sqe->off = 0;
+    sqe->buf_group = RECV_BUFFER_GROUP;
+    sqe->flags = IOSQE_CQE_SKIP_SUCCESS;
+    sqe->user_data = _pack_user_data(UserData::kProvide, 0, 0);
+
+    //registered send region, pinned once so writes skip the per-call page lookup
+    send_region = (uint8_t *) mmap(nullptr, MAX_CONNECTIONS * SEND_BUFFER_LEN, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_POPULATE, -1, 0);
+    struct iovec iov = { send_region, MAX_CONNECTIONS * SEND_BUFFER_LEN };
+    send_region_registered = syscall(__NR_io_uring_register, ring.fd, IORING_REGISTER_BUFFERS, &iov, 1) == 0;
+    if (!send_region_registered)
+        std::cout << "could not register send buffers (RLIMIT_MEMLOCK?), using plain sends\n";
+    for (uint32_t i = MAX_CONNECTIONS; i > 0; --i) {
+        CONNECTIONS[i - 1].out = send_region + (i - 1) * SEND_BUFFER_LEN;
+        free_connections.push(i - 1);
+    }
+}
+
+static void _recycle_recv_buffer(uint16_t bid) {
+    struct io_uring_sqe *sqe = _get_sqe();
+    sqe->opcode = IORING_OP_PROVIDE_BUFFERS;
+    sqe->fd = 1;
+    sqe->addr = (uint64_t) (recv_buffers + bid * RECV_BUFFER_LEN);
+    sqe->len = RECV_BUFFER_LEN;
+    sqe->off = bid;
+    sqe->buf_group = RECV_BUFFER_GROUP;
+    sqe->flags = IOSQE_CQE_SKIP_SUCCESS;
+    sqe->user_data = _pack_user_data(UserData::kProvide, 0, 0);
+}
+
+//idx 0 is the game listener, 1 the metrics listener
+static void _arm_accept(uint32_t listener) {
+    struct io_uring_sqe *sqe = _get_sqe();
+    sqe->opcode = IORING_OP_ACCEPT;
+    sqe->fd = listener == 0 ? listen_fd : metrics_fd;
+    sqe->ioprio = IORING_ACCEPT_MULTISHOT;
+    sqe->user_data = _pack_user_data(UserData::kAccept, listener, 0);
+}
+
+static void _arm_recv(uint32_t idx) {
+    Connection &conn = CONNECTIONS[idx];
+    struct io_uring_sqe *sqe = _get_sqe();
+    sqe->opcode = IORING_OP_RECV;
+    sqe->fd = conn.fd;
+    sqe->ioprio = IORING_RECV_MULTISHOT;
+    sqe->flags = IOSQE_BUFFER_SELECT;
+    sqe->buf_group = RECV_BUFFER_GROUP;
+    sqe->user_data = _pack_user_data(UserData::kRecv, idx, conn.generation);
+    conn.recv_armed = 1;
+}
+
+static void _arm_timeout() {
+    struct io_uring_sqe *sqe = _get_sqe();
+    sqe->opcode = IORING_OP_TIMEOUT;
+    sqe->addr = (uint64_t) &next_tick;
+    sqe->len = 1;
+    sqe->timeout_flags = IORING_TIMEOUT_ABS;
+    sqe->user_data = _pack_user_data(UserData::kTimeout, 0, 0);
+}
+
+static void _submit_write(uint32_t idx) {
+    Connection &conn = CONNECTIONS[idx];
+    if (conn.write_in_flight || conn.out_head == conn.out_tail) return;
+    if (conn.out_head > 0) {
+        std::memmove(conn.out, conn.out + conn.out_head, conn.out_tail - conn.out_head);
+        conn.out_tail -= conn.out_head;
+        conn.out_head = 0;
+    }
+    struct io_uring_sqe *sqe = _get_sqe();
+    if (send_region_registered) {
+        sqe->opcode = IORING_OP_WRITE_FIXED;
+        sqe->buf_index = 0;
+    } else {
+        sqe->opcode = IORING_OP_SEND;
+        sqe->msg_flags = MSG_NOSIGNAL;
+    }
+    sqe->fd = conn.fd;
+    sqe->addr = (uint64_t) conn.out;
+    sqe->len = conn.out_tail;
+    sqe->user_data = _pack_user_data(UserData::kWrite, idx, conn.generation);
+    conn.write_in_flight = 1;
+    ++Server::transport_stats.socket_writes;
+}
+
+static void _queue_flush(uint32_t idx) {
+    Connection &conn = CONNECTIONS[idx];
+    if (conn.flush_queued || conn.out_head == conn.out_tail) return;
+    conn.flush_queued = 1;
+    pending_flush.push(idx);
+}
+
+static void _flush_writes() {
+    for (uint32_t idx : pending_flush) {
+        CONNECTIONS[idx].flush_queued = 0;
+        if (CONNECTIONS[idx].fd >= 0) _submit_write(idx);
+    }
+    pending_flush.clear();
+}
+
+static uint8_t _queue_raw(Connection &conn, uint8_t const *data, size_t len) {
+    if (conn.out_tail + len > SEND_BUFFER_LEN) return 0;
+    std::memcpy(conn.out + conn.out_tail, data, len);
+    conn.out_tail += len;
+    if (conn.write_in_flight) Server::net_stats.bytes_buffered += len;
+    return 1;
+}
+
+static uint8_t _queue_frame(Connection &conn, uint8_t opcode, uint8_t const *payload, size_t len) {
+    uint8_t header[10];
+    uint32_t header_len = 2;
+    header[0] = 0x80 | opcode;
+    if (len < 126)
+        header[1] = len;
+    else if (len <= 0xffff) {
+        header[1] = 126;
+        header[2] = len >> 8;
+        header[3] = len & 0xff;
+        header_len = 4;
+    } else {
+        header[1] = 127;
+        for (uint32_t i = 0; i < 8; ++i)
+            header[2 + i] = (uint64_t(len) >> (56 - 8 * i)) & 0xff;
+        header_len = 10;
+    }
+    if (conn.out_tail + header_len + len > SEND_BUFFER_LEN) return 0;
+    _queue_raw(conn, header, header_len);
+    _queue_raw(conn, payload, len);
+    return 1;
+}
+
+static void _finalize_close(uint32_t idx) {
+    Connection &conn = CONNECTIONS[idx];
+    if (conn.recv_armed || conn.write_in_flight || conn.in_recv) return;
+    if (conn.ws != nullptr) {
+        Client::on_disconnect(conn.ws, 1006, {});
+        delete conn.ws;
+        conn.ws = nullptr;
+    }
+    close(conn.fd);
+    conn.fd = -1;
+    conn.upgraded = 0;
+    conn.metrics = 0;
+    conn.closing = 0;
+    conn.in_len = 0;
+    conn.out_head = conn.out_tail = 0;
+    ++conn.generation;
+    free_connections.push(idx);
+}
+
+static void _begin_close(uint32_t idx) {
+    Connection &conn = CONNECTIONS[idx];
+    if (!conn.closing) {
+        conn.closing = 1;
+        //wakes the outstanding multishot recv with eof so the slot can be reclaimed
+        shutdown(conn.fd, SHUT_RDWR);
+    }
+    _finalize_close(idx);
+}
+
+static void _close_after_flush(uint32_t idx) {
+    Connection &conn = CONNECTIONS[idx];
+    if (conn.closing) return;
+    if (!conn.write_in_flight && conn.out_head == conn.out_tail) {
+        _begin_close(idx);
+        return;
+    }
+    //let queued frames (eg. kOutdated) go out before the socket is torn down
+    conn.closing = 1;
+    //from here the idle timeout bounds the flush, in case the peer has stopped reading
+    conn.last_recv = tick_count;
+    _submit_write(idx);
+    shutdown(conn.fd, SHUT_RD);
+}
+
+static uint8_t _handshake(uint32_t idx, uint8_t const *data, uint32_t len, uint32_t &consumed) {
+    std::string_view request(reinterpret_cast<char const *>(data), len);
+    size_t end = request.find("\r\n\r\n");
+    if (end == std::string_view::npos) {
+        consumed = 0;
+        return len < MAX_REQUEST_LEN;
+    }
+    consumed = end + 4;
+    std::string_view key;
+    size_t at = 0;
+    while (at < end) {
+        size_t line_end = request.find("\r\n", at);
+        std::string_view line = request.substr(at, line_end - at);
+        at = line_end + 2;
+        if (line.size() < 18 || strncasecmp(line.data(), "sec-websocket-key:", 18) != 0) continue;
+        key = line.substr(18);
+        while (key.size() > 0 && key.front() == ' ') key.remove_prefix(1);
+        while (key.size() > 0 && key.back() == ' ') key.remove_suffix(1);
+    }
+    Connection &conn = CONNECTIONS[idx];
+    if (key.size() == 0 || key.size() > 64) {
+        char const *response = "HTTP/1.1 426 Upgrade Required\r\nConnection: close\r\nContent-Length: 0\r\n\r\n";
+        _queue_raw(conn, reinterpret_cast<uint8_t const *>(response), std::strlen(response));
+        return 0;
+    }
+    std::string accept_src(key);
+    accept_src += "258EAFA5-E914-47DA-95CA-C5AB0DC85B11";
+    uint8_t digest[EVP_MAX_MD_SIZE];
+    uint32_t digest_len = 0;
+    EVP_Digest(accept_src.data(), accept_src.size(), digest, &digest_len, EVP_sha1(), nullptr);
+    uint8_t accept[64];
+    EVP_EncodeBlock(accept, digest, digest_len);
+    std::string response = "HTTP/1.1 101 Switching Protocols\r\nUpgrade: websocket\r\nConnection: Upgrade\r\nSec-WebSocket-Accept: ";
+    response += reinterpret_cast<char const *>(accept);
+    response += "\r\n\r\n";
+    _queue_raw(conn, reinterpret_cast<uint8_t const *>(response.data()), response.size());
+    conn.upgraded = 1;
+    std::cout << "client connection\n";
+    conn.ws = new WebSocket(idx);
+    return 1;
+}
+
+static int32_t _serve_metrics(uint32_t idx, uint8_t const *data, uint32_t len) {
+    std::string_view request(reinterpret_cast<char const *>(data), len);
+    if (request.find("\r\n\r\n") == std::string_view::npos)
+        return len < MAX_REQUEST_LEN ? 0 : -1;
+    std::string body;
+    std::string response;
+    if (request.starts_with("GET /metrics ")) {
+        body = Metrics::render();
+        response = "HTTP/1.1 200 OK\r\nContent-Type: text/plain; version=0.0.4\r\n";
+    } else response = "HTTP/1.1 404 Not Found\r\n";
+    response += "Connection: close\r\nContent-Length: " + std::to_string(body.size()) + "\r\n\r\n";
+    response += body;
+    _queue_raw(CONNECTIONS[idx], reinterpret_cast<uint8_t const *>(response.data()), response.size());
+    //one request per connection
+    return -1;
+}
+
+//returns the number of bytes consumed, or -1 if the connection should be closed
+static int32_t _process_input(uint32_t idx, uint8_t *data, uint32_t len) {
+    Connection &conn = CONNECTIONS[idx];
+    if (conn.metrics) return _serve_metrics(idx, data, len);
+    uint32_t at = 0;
+    if (!conn.upgraded) {
+        uint32_t consumed;
+        if (!_handshake(idx, data, len, consumed)) return -1;
+        if (!conn.upgraded) return 0;
+        at = consumed;
+    }
+    while (!conn.closing && len - at >= 2) {
+        uint8_t *frame = data + at;
+        uint8_t fin = frame[0] & 0x80;
+        uint8_t opcode = frame[0] & 0x0f;
+        //client frames must be masked
+        if (!(frame[1] & 0x80)) return -1;
+        uint32_t payload_len = frame[1] & 0x7f;
+        uint32_t header_len = 2;
+        if (payload_len == 126) {
+            if (len - at < 4) break;
+            payload_len = (frame[2] << 8) | frame[3];
+            header_len = 4;
+        } else if (payload_len == 127) return -1;
+        if (payload_len > MAX_PAYLOAD_LEN || !fin) return -1;
+        if (len - at < header_len + 4 + payload_len) break;
+        uint8_t const *mask = frame + header_len;
+        uint8_t *payload = frame + header_len + 4;
+        for (uint32_t i = 0; i < payload_len; ++i)
+            payload[i] ^= mask[i & 3];
+        at += header_len + 4 + payload_len;
+        switch (opcode) {
+            case 0x1:
+            case 0x2:
+                Client::on_message(conn.ws, std::string_view(reinterpret_cast<char const *>(payload), payload_len), opcode);
+                break;
+            case 0x8:
+                _queue_frame(conn, 0x8, payload, payload_len > 2 ? 2 : payload_len);
+                conn.ws->end();
+                break;
+            case 0x9:
+                _queue_frame(conn, 0xA, payload, payload_len);
+                break;
+            case 0xA:
+                break;
+            default:
+                return -1;
+        }
+    }
+    return at;
+}
+
+static void _on_recv(uint32_t idx, int32_t res, uint32_t flags) {
+    Connection &conn = CONNECTIONS[idx];
+    if (!(flags & IORING_CQE_F_MORE)) conn.recv_armed = 0;
+    if (res == -ENOBUFS) {
+        //ran out of ring buffers, try again once some are recycled
+        if (!conn.recv_armed && !conn.closing) _arm_recv(idx);
+        return;
+    }
+    if (res <= 0 || conn.closing) {
+        if (flags & IORING_CQE_F_BUFFER) _recycle_recv_buffer(flags >> IORING_CQE_BUFFER_SHIFT);
+        _begin_close(idx);
+        return;
+    }
+    uint16_t bid = flags >> IORING_CQE_BUFFER_SHIFT;
+    uint8_t *data = recv_buffers + bid * RECV_BUFFER_LEN;
+    conn.last_recv = tick_count;
+    conn.pinged = 0;
+    int32_t consumed;
+    conn.in_recv = 1;
+    if (conn.in_len == 0) {
+        //common case, parse straight out of the kernel buffer
+        consumed = _process_input(idx, data, res);
+        if (consumed >= 0 && (uint32_t) res - consumed > MAX_REQUEST_LEN) consumed = -1;
+        if (consumed >= 0) {
+            conn.in_len = res - consumed;
+            std::memcpy(conn.in, data + consumed, conn.in_len);
+        }
+    } else {
+        if (conn.in_len + res > MAX_REQUEST_LEN) consumed = -1;
+        else {
+            std::memcpy(conn.in + conn.in_len, data, res);
+            conn.in_len += res;
+            consumed = _process_input(idx, conn.in, conn.in_len);
+            if (consumed > 0) {
+                std::memmove(conn.in, conn.in + consumed, conn.in_len - consumed);
+                conn.in_len -= consumed;
+            }
+        }
+    }
+    conn.in_recv = 0;
+    _recycle_recv_buffer(bid);
+    //a message handler ended the connection
+    if (conn.closing) {
+        _finalize_close(idx);
+        return;
+    }
+    if (consumed < 0) {
+        _close_after_flush(idx);
+        return;
+    }
+    _queue_flush(idx);
+    if (!conn.recv_armed && !conn.closing) _arm_recv(idx);
+}
+
+static void _on_write(uint32_t idx, int32_t res) {
+    Connection &conn = CONNECTIONS[idx];
+    conn.write_in_flight = 0;
+    if (res < 0) {
+        _begin_close(idx);
+        return;
+    }
+    conn.out_head += res;
+    if (conn.out_head == conn.out_tail) {
+        conn.out_head = conn.out_tail = 0;
+        if (conn.ws != nullptr && conn.ws->getUserData()->congestion == CongestionState::kCongested)
+            conn.ws->getUserData()->congestion = CongestionState::kResync;
+    }
+    _submit_write(idx);
+    if (conn.closing) _finalize_close(idx);
+}
+
+static void _on_accept(uint32_t listener, int32_t res, uint32_t flags) {
+    if (!(flags & IORING_CQE_F_MORE)) _arm_accept(listener);
+    if (res < 0) return;
+    if (free_connections.size() == 0) {
+        close(res);
+        return;
+    }
+    uint32_t idx = free_connections.pop();
+    Connection &conn = CONNECTIONS[idx];
+    int one = 1;
+    setsockopt(res, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    conn.fd = res;
+    conn.metrics = listener == 1;
+    conn.last_recv = tick_count;
+    conn.pinged = 0;
+    _arm_recv(idx);
+}
+
+static void _check_idle() {
+    for (uint32_t i = 0; i < MAX_CONNECTIONS; ++i) {
+        Connection &conn = CONNECTIONS[i];
+        if (conn.fd < 0) continue;
+        uint32_t idle = tick_count - conn.last_recv;
+        if (idle > IDLE_TIMEOUT) {
+            //a flush the peer isn't reading never completes, shutting the write side fails it
+            if (conn.closing) shutdown(conn.fd, SHUT_RDWR);
+            _begin_close(i);
+        } else if (conn.upgraded && !conn.closing && idle > IDLE_TIMEOUT / 2 && !conn.pinged) {
+            _queue_frame(conn, 0x9, nullptr, 0);
+            _queue_flush(i);
+            conn.pinged = 1;
+        }
+    }
+}
+
+static void _on_timeout() {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    int64_t interval = 1000000000 / TPS;
+    next_tick.tv_nsec += interval;
+    while (next_tick.tv_nsec >= 1000000000) {
+        next_tick.tv_nsec -= 1000000000;
+        ++next_tick.tv_sec;
+    }
+    //fell more than a tick behind, don't try to catch up
+    if (next_tick.tv_sec < now.tv_sec || (next_tick.tv_sec == now.tv_sec && next_tick.tv_nsec < now.tv_nsec)) {
+        next_tick.tv_sec = now.tv_sec;
+        next_tick.tv_nsec = now.tv_nsec + interval;
+        if (next_tick.tv_nsec >= 1000000000) {
+            next_tick.tv_nsec -= 1000000000;
+            ++next_tick.tv_sec;
+        }
+    }
+    _arm_timeout();
+    Server::tick();
+    ++tick_count;
+    if (tick_count % TPS == 0) _check_idle();
+}
+
+WebSocketServer::WebSocketServer() {
+    std::signal(SIGPIPE, SIG_IGN);
+    _ring_init();
+    listen_fd = socket(AF_INET6, SOCK_STREAM, 0);
+    int one = 1, zero = 0;
+    setsockopt(listen_fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    setsockopt(listen_fd, IPPROTO_IPV6, IPV6_V6ONLY, &zero, sizeof(zero));
+    struct sockaddr_in6 addr;
+    std::memset(&addr, 0, sizeof(addr));
+    addr.sin6_family = AF_INET6;
+    addr.sin6_addr = in6addr_any;
+    addr.sin6_port = htons(SERVER_PORT);
+    if (bind(listen_fd, (struct sockaddr *) &addr, sizeof(addr)) < 0 || listen(listen_fd, 512) < 0) {
+        std::perror("listen");
+        std::exit(1);
+    }
+    std::cout << "Listening on port " << SERVER_PORT << std::endl;
+
+    metrics_fd = socket(AF_INET, SOCK_STREAM, 0);
+    setsockopt(metrics_fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    struct sockaddr_in metrics_addr;
+    std::memset(&metrics_addr, 0, sizeof(metrics_addr));
+    metrics_addr.sin_family = AF_INET;
+    metrics_addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    metrics_addr.sin_port = htons(METRICS_PORT);
+    if (bind(metrics_fd, (struct sockaddr *) &metrics_addr, sizeof(metrics_addr)) < 0 || listen(metrics_fd, 16) < 0) {
+        //not fatal, the game runs without it
+        std::perror("metrics listen");
+        close(metrics_fd);
+        metrics_fd = -1;
+    } else std::cout << "Serving metrics on 127.0.0.1:" << METRICS_PORT << std::endl;
+}
+
+void Server::run() {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    next_tick.tv_sec = now.tv_sec;
+    next_tick.tv_nsec = now.tv_nsec;
+    _arm_accept(0);
+    if (metrics_fd >= 0) _arm_accept(1);
+    _arm_timeout();
+    while (1) {
+        _flush_writes();
+        if (_ring_submit(1) < 0) {
+            std::perror("io_uring_enter");
+            std::exit(1);
+        }
+        uint32_t head = *ring.cq_head;
+        uint32_t tail = __atomic_load_n(ring.cq_tail, __ATOMIC_ACQUIRE);
+        for (; head != tail; ++head) {
+            struct io_uring_cqe const &cqe = ring.cqes[head & *ring.cq_mask];
+            uint8_t type = cqe.user_data >> 56;
+            uint32_t idx = cqe.user_data & 0xffff;
+            uint32_t generation = (cqe.user_data >> 16) & 0xffffffff;
+            if ((type == UserData::kRecv || type == UserData::kWrite) && CONNECTIONS[idx].generation != generation) {
+                if (cqe.flags & IORING_CQE_F_BUFFER) _recycle_recv_buffer(cqe.flags >> IORING_CQE_BUFFER_SHIFT);
+                continue;
+            }
+            switch (type) {
+                case UserData::kAccept:
+                    _on_accept(idx, cqe.res, cqe.flags);
+                    break;
+                case UserData::kRecv:
+                    _on_recv(idx, cqe.res, cqe.flags);
+                    break;
+                case UserData::kWrite:
+                    _on_write(idx, cqe.res);
+                    break;
+                case UserData::kTimeout:
+                    _on_timeout();
+                    break;
+                default:
+                    break;
+            }
+        }
+        __atomic_store_n(ring.cq_head, head, __ATOMIC_RELEASE);
+    }
+}
+
+uint8_t Client::send_packet(uint8_t const *packet, size_t size) {
+    if (ws == nullptr) return 0;
+    if (!ws->send(packet, size)) return 0;
+    ++Server::net_stats.packets_sent;
+    Server::net_stats.bytes_sent += size;
+    if (ws->getBufferedAmount() > CONGESTION_HIGH_WATER && congestion == CongestionState::kFlowing)
+        congestion = CongestionState::kCongested;
+    return 1;
+}
+
+WebSocket::WebSocket(int id) : ws_id(id) {
+    client.ws = this;
+}
+
+uint8_t WebSocket::send(uint8_t const *packet, size_t size) {
+    Connection &conn = CONNECTIONS[ws_id];
+    if (conn.closing) return 0;
+    //no room left, the client misses this update and catches up once drained
+    if (!_queue_frame(conn, 0x2, packet, size)) {
+        client.congestion = CongestionState::kCongested;
+        return 0;
+    }
+    _queue_flush(ws_id);
+    return 1;
+}
+
+void WebSocket::end() {
+    _close_after_flush(ws_id);
+}
+
+size_t WebSocket::getBufferedAmount() const {
+    Connection const &conn = CONNECTIONS[ws_id];
+    return conn.out_tail - conn.out_head;
+}
+
+Client *WebSocket::getUserData() {
+    return &client;
+}
+
+WebSocketServer Server::server;
+#endif
@@ -4,16 +4,71 @@
 
 #include <Shared/Config.hh>
 
+#include <cstring>
 #include <iostream>
 #include <string>
 #include <unordered_map>
+#include <vector>
 
 #include <emscripten.h>
 
 std::unordered_map<int, WebSocket *> WS_MAP;
 
+//crossing into js and back is the expensive part on node, so i/o is batched per tick
+//js appends inbound messages as [ws_id][len][payload] records straight into INBOUND_BUFFER,
+//which is drained and reset at the start of the tick
+//outbound packets are copied into one arena and handed to js in a single call after the tick
 size_t const MAX_BUFFER_LEN = 1024;
-static uint8_t INCOMING_BUFFER[MAX_BUFFER_LEN] = {0};
+size_t const INBOUND_BUFFER_LEN = 256 * 1024;
+static uint8_t INBOUND_BUFFER[INBOUND_BUFFER_LEN] __attribute__((aligned(4))) = {0};
+static uint32_t INBOUND_LEN = 0;
+
+//len == CLOSE_ENTRY closes the socket after everything queued before it was sent
+uint32_t const CLOSE_ENTRY = UINT32_MAX;
+struct OutboundEntry {
+    int32_t ws_id;
+    uint32_t offset;
+    uint32_t len;
+};
+static std::vector<OutboundEntry> OUTBOUND_TABLE;
+static std::vector<uint8_t> OUTBOUND_ARENA;
+
+static void _drain_inbound() {
+    uint32_t at = 0;
+    while (at < INBOUND_LEN) {
+        int32_t ws_id;
+        uint32_t len;
+        std::memcpy(&ws_id, INBOUND_BUFFER + at, sizeof(int32_t));
+        std::memcpy(&len, INBOUND_BUFFER + at + 4, sizeof(uint32_t));
+        auto iter = WS_MAP.find(ws_id);
+        //the socket may have closed since the message was queued
+        if (iter != WS_MAP.end()) {
+            std::string_view message(reinterpret_cast<char const *>(INBOUND_BUFFER + at + 8), len);
+            Client::on_message(iter->second, message, 0);
+        }
+        at += (8 + len + 3) & ~3;
+    }
+    INBOUND_LEN = 0;
+}
+
+static void _flush_outbound() {
+    if (OUTBOUND_TABLE.size() == 0) return;
+    EM_ASM({
+        const conns = Module.ws_connections;
+        for (let i = 0; i < $1; ++i) {
+            const entry = ($0 >> 2) + i * 3;
+            const ws = conns[HEAP32[entry]];
+            if (!ws) continue;
+            const offset = HEAPU32[entry + 1];
+            const len = HEAPU32[entry + 2];
+            if (len === ($3 >>> 0)) ws.close();
+            //copied, node may hold on to the buffer past the next tick
+            else ws.send(HEAPU8.slice($2 + offset, $2 + offset + len));
+        }
+    }, OUTBOUND_TABLE.data(), OUTBOUND_TABLE.size(), OUTBOUND_ARENA.data(), CLOSE_ENTRY);
+    OUTBOUND_TABLE.clear();
+    OUTBOUND_ARENA.clear();
+}
 
 extern "C" {
     void on_connect(int ws_id) {
@@ -29,14 +84,9 @@ extern "C" {
     }
 
     void tick() {
+        _drain_inbound();
         Server::tick();
-    }
-
-    void on_message(int ws_id, uint32_t len) {
-        WebSocket *ws = WS_MAP[ws_id];
-        if (ws == nullptr) return;
-        std::string_view message(reinterpret_cast<char const *>(INCOMING_BUFFER), len);
-        Client::on_message(ws, message, 0);
+        _flush_outbound();
     }
 }
 
@@ -85,18 +135,22 @@ WebSocketServer::WebSocketServer() {
             _on_connect(ws_id);
             curr_id = (curr_id + 1) | 0;
             ws.on("message", function(message){
-                let data = new Uint8Array(message);
-                const len = data.length > $2 ? $2 : data.length;
-                data = data.subarray(0, len);
-                HEAPU8.set(data, $1);
-                _on_message(ws_id, len);
+                const len = message.length > $2 ? $2 : message.length;
+                const used = HEAPU32[$4 >> 2];
+                const record = (8 + len + 3) & ~3;
+                //full until the next tick drains it, same as a dropped packet
+                if (used + record > $3) return;
+                HEAP32[($1 + used) >> 2] = ws_id;
+                HEAPU32[($1 + used + 4) >> 2] = len;
+                HEAPU8.set(message.subarray(0, len), $1 + used + 8);
+                HEAPU32[$4 >> 2] = used + record;
             });
             ws.on("close", function(reason){
                 _on_disconnect(ws_id, reason);
                 delete Module.ws_connections[ws_id];
             });
         })
-    }, SERVER_PORT, INCOMING_BUFFER, MAX_BUFFER_LEN);
+    }, SERVER_PORT, INBOUND_BUFFER, MAX_BUFFER_LEN, INBOUND_BUFFER_LEN, &INBOUND_LEN);
 }
 
 void Server::run() {
@@ -105,9 +159,13 @@ void Server::run() {
     }, 1000 / TPS);
 }
 
-void Client::send_packet(uint8_t const *packet, size_t size) {
-    if (ws == nullptr) return;
+uint8_t Client::send_packet(uint8_t const *packet, size_t size) {
+    if (ws == nullptr) return 0;
     ws->send(packet, size);
+    ++Server::net_stats.packets_sent;
+    ++Server::transport_stats.socket_writes;
+    Server::net_stats.bytes_sent += size;
+    return 1;
 }
 
 WebSocket::WebSocket(int id) : ws_id(id) {
@@ -116,20 +174,14 @@ WebSocket::WebSocket(int id) : ws_id(id) {
     WS_MAP.insert({id, this});
 }
 
-void WebSocket::send(uint8_t const *packet, size_t size) {
-    EM_ASM({
-        if (!Module.ws_connections || !Module.ws_connections[$0]) return;
-        const ws = Module.ws_connections[$0];
-        ws.send(HEAPU8.subarray($1,$1+$2));
-    }, ws_id, packet, size);
+uint8_t WebSocket::send(uint8_t const *packet, size_t size) {
+    OUTBOUND_TABLE.push_back({ ws_id, (uint32_t) OUTBOUND_ARENA.size(), (uint32_t) size });
+    OUTBOUND_ARENA.insert(OUTBOUND_ARENA.end(), packet, packet + size);
+    return 1;
 }
 
 void WebSocket::end() {
-    EM_ASM({
-        if (!Module.ws_connections || !Module.ws_connections[$0]) return;
-        const ws = Module.ws_connections[$0];
-        ws.close();
-    }, ws_id);
+    OUTBOUND_TABLE.push_back({ ws_id, 0, CLOSE_ENTRY });
 }
 
 Client *WebSocket::getUserData() {
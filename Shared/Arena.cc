@@ -7,8 +7,8 @@ Arena::Arena() {
 }
 
 void Arena::init() {
-    #define SINGLE(name, type) name = {};
-    #define MULTIPLE(name, type, count) for (uint32_t i = 0; i > count; ++i) name[i] = {};
+    #define SINGLE(name, type) SERVER_ONLY(release_field(name);) name = {};
+    #define MULTIPLE(name, type, count) for (uint32_t i = 0; i < count; ++i) { SERVER_ONLY(release_field(name[i]);) name[i] = {}; }
     FIELDS_Arena
     #undef SINGLE
     #undef MULTIPLE
@@ -25,14 +25,18 @@ void Arena::reset_protocol() {
 
 #ifdef SERVERSIDE
 #define SINGLE(name, type) \
-void Arena::set_##name(type const v) { \
+void Arena::set_##name(type const &v) { \
     if (name == v) return; \
+    retain_field(v); \
+    release_field(name); \
     name = v; \
     BIT_SET_ARR(state, k##name); \
 }
 #define MULTIPLE(name, type, amt) \
-void Arena::set_##name(uint32_t i, type const v) { \
+void Arena::set_##name(uint32_t i, type const &v) { \
     if (name[i] == v) return; \
+    retain_field(v); \
+    release_field(name[i]); \
     name[i] = v; \
     BIT_SET_ARR(state, k##name); \
     BIT_SET_ARR(state_per_##name, i); \
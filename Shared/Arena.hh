@@ -2,8 +2,8 @@
 
 #include <Shared/Helpers.hh>
 #include <Shared/StaticData.hh>
+#include <Shared/StringTable.hh>
 
-#include <string>
 #include <stdint.h>
 
 SERVER_ONLY(class Writer;)
@@ -12,7 +12,7 @@ CLIENT_ONLY(class Reader;)
 #define FIELDS_Arena \
     SINGLE(player_count, uint32_t) \
     MULTIPLE(scores, Float, LEADERBOARD_SIZE) \
-    MULTIPLE(names, std::string, LEADERBOARD_SIZE) \
+    MULTIPLE(names, StringID, LEADERBOARD_SIZE) \
     MULTIPLE(colors, uint8_t, LEADERBOARD_SIZE)
 
 class Arena {
@@ -42,8 +42,8 @@ public:
     void reset_protocol();
 #ifdef SERVERSIDE
     void write(Writer *, uint8_t);
-    #define SINGLE(name, type) void set_##name(type const);
-    #define MULTIPLE(name, type, amt) void set_##name(uint32_t, type const);
+    #define SINGLE(name, type) void set_##name(type const &);
+    #define MULTIPLE(name, type, amt) void set_##name(uint32_t, type const &);
     FIELDS_Arena
     #undef SINGLE
     #undef MULTIPLE
@@ -79,6 +79,11 @@ void Writer::write<EntityID>(EntityID const &id) {
     if (id.id) write<EntityID::hash_type>(id.hash);
 }
 
+template<>
+void Writer::write<StringID>(StringID const &str) {
+    write<StringID::id_type>(str.id);
+}
+
 template<>
 void Writer::write<std::string>(std::string const &str) {
     uint32_t len = str.size();
@@ -162,6 +167,11 @@ EntityID Reader::read<EntityID>() {
     return {id, hash};
 }
 
+template<>
+StringID Reader::read<StringID>() {
+    return StringID(read<StringID::id_type>());
+}
+
 template<>
 void Reader::read<uint8_t>(uint8_t &ref) {
     ref = read<uint8_t>();
@@ -212,6 +222,11 @@ void Reader::read<EntityID>(EntityID &ref) {
     ref = read<EntityID>();
 }
 
+template<>
+void Reader::read<StringID>(StringID &ref) {
+    ref = read<StringID>();
+}
+
 template<>
 void Reader::read<std::string>(std::string &ref) {
     uint32_t len = read<uint32_t>();
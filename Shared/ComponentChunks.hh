@@ -0,0 +1,45 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+//hands out blocks for a component's fields from contiguous chunks of N, so entities with the same
+//component sit next to each other and the rest don't carry the space
+//blocks never move and chunks are never returned, a released block goes back on the free list
+template<typename T, uint32_t N = 64>
+class ComponentChunks {
+    std::vector<T *> chunks;
+    std::vector<T *> free_blocks;
+public:
+    ComponentChunks() = default;
+    ComponentChunks(ComponentChunks const &) = delete;
+    ComponentChunks &operator=(ComponentChunks const &) = delete;
+
+    T *acquire() {
+        if (free_blocks.empty()) {
+            T *chunk = new T[N];
+            chunks.push_back(chunk);
+            //room for every block to be free at once, so release never allocates
+            free_blocks.reserve(capacity());
+            //hand out the chunk front to back
+            for (uint32_t i = N; i > 0; --i)
+                free_blocks.push_back(chunk + i - 1);
+        }
+        T *block = free_blocks.back();
+        free_blocks.pop_back();
+        block->reset();
+        return block;
+    }
+
+    void release(T *block) {
+        free_blocks.push_back(block);
+    }
+
+    uint32_t capacity() const {
+        return chunks.size() * N;
+    }
+
+    uint32_t in_use() const {
+        return capacity() - free_blocks.size();
+    }
+};
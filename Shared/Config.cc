@@ -4,8 +4,9 @@
 #endif
 
 
-extern const uint64_t VERSION_HASH = 4728567265382323ll;
+extern const uint64_t VERSION_HASH = 6194830275163847ll;
 extern const uint32_t SERVER_PORT = 2053;
+extern const uint32_t METRICS_PORT = 9101;
 extern const uint32_t MAX_NAME_LENGTH = 16;
 
 std::string get_ws_url() {
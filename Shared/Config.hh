@@ -6,4 +6,6 @@
 std::string get_ws_url();
 extern uint64_t const VERSION_HASH;
 extern uint32_t const SERVER_PORT;
+//loopback only, serves /metrics
+extern uint32_t const METRICS_PORT;
 extern uint32_t const MAX_NAME_LENGTH;
\ No newline at end of file
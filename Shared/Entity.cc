@@ -3,27 +3,230 @@
 #include <Shared/Binary.hh>
 #include <Shared/StaticData.hh>
 
+#ifndef INLINE_COMPONENTS
+#define COMPONENT(name) ComponentChunks<name##Data> name##_chunks;
+PER_CHUNKED_COMPONENT
+#undef COMPONENT
+#endif
+
+#define SINGLE(component, name, type) SERVER_ONLY(release_field(name);) name = {};
+#define MULTIPLE(component, name, type, amt) for (uint32_t n = 0; n < amt; ++n) { SERVER_ONLY(release_field(name[n]);) name[n] = {}; }
+#define EXTRA_SINGLE(component, name, type, reset) name reset;
+#define EXTRA_MULTIPLE(component, name, type, amt, reset) for (uint32_t n = 0; n < amt; ++n) { name[n] reset; }
+#define COMPONENT(name) \
+void name##Data::reset() { \
+    FIELDS_##name \
+    EXTRA_FIELDS_##name \
+}
+PER_CHUNKED_COMPONENT
+#undef COMPONENT
+#undef SINGLE
+#undef MULTIPLE
+#undef EXTRA_SINGLE
+#undef EXTRA_MULTIPLE
+
+#ifdef SERVERSIDE
+void EntityHotArrays::reserve(uint32_t count) {
+    components.reserve(count);
+    pending_delete.reserve(count);
+    dirty.reserve(count);
+    listed_dirty.reserve(count);
+    #define SINGLE(component, name, type) name.reserve(count);
+    #define MULTIPLE(component, name, type, amt) name.reserve(count);
+    #define COMPONENT(name) FIELDS_##name
+    PER_HOT_COMPONENT
+    #undef COMPONENT
+    #undef SINGLE
+    #undef MULTIPLE
+    #define SINGLE(name, type, reset)
+    #define MULTIPLE(name, type, amt, reset)
+    #define HOT_SINGLE(name, type, reset) name.reserve(count);
+    PER_EXTRA_FIELD
+    #undef SINGLE
+    #undef MULTIPLE
+    #undef HOT_SINGLE
+}
+
+void EntityHotArrays::commit(uint32_t count) {
+    components.commit(count);
+    pending_delete.commit(count);
+    dirty.commit(count);
+    listed_dirty.commit(count);
+    #define SINGLE(component, name, type) name.commit(count);
+    #define MULTIPLE(component, name, type, amt) name.commit(count);
+    #define COMPONENT(name) FIELDS_##name
+    PER_HOT_COMPONENT
+    #undef COMPONENT
+    #undef SINGLE
+    #undef MULTIPLE
+    #define SINGLE(name, type, reset)
+    #define MULTIPLE(name, type, amt, reset)
+    #define HOT_SINGLE(name, type, reset) name.commit(count);
+    PER_EXTRA_FIELD
+    #undef SINGLE
+    #undef MULTIPLE
+    #undef HOT_SINGLE
+}
+
+uint32_t EntityHotArrays::bytes_per_entity() {
+    uint32_t bytes = sizeof(uint32_t) + sizeof(uint8_t) + sizeof(EntityID::id_type) + sizeof(uint8_t);
+    #define SINGLE(component, name, type) bytes += sizeof(type);
+    #define MULTIPLE(component, name, type, amt) bytes += sizeof(type) * amt;
+    #define COMPONENT(name) FIELDS_##name
+    PER_HOT_COMPONENT
+    #undef COMPONENT
+    #undef SINGLE
+    #undef MULTIPLE
+    #define SINGLE(name, type, reset)
+    #define MULTIPLE(name, type, amt, reset)
+    #define HOT_SINGLE(name, type, reset) bytes += sizeof(type);
+    PER_EXTRA_FIELD
+    #undef SINGLE
+    #undef MULTIPLE
+    #undef HOT_SINGLE
+    return bytes;
+}
+
+void EntityHotArrays::reset(EntityID::id_type i) {
+    components[i] = 0;
+    pending_delete[i] = 0;
+    #define SINGLE(component, name, type) name[i] = {};
+    #define MULTIPLE(component, name, type, amt) for (uint32_t n = 0; n < amt; ++n) { name[i][n] = {}; }
+    #define COMPONENT(name) FIELDS_##name
+    PER_HOT_COMPONENT
+    #undef COMPONENT
+    #undef SINGLE
+    #undef MULTIPLE
+    #define SINGLE(name, type, reset)
+    #define MULTIPLE(name, type, amt, reset)
+    #define HOT_SINGLE(name, type, reset) name[i] reset;
+    PER_EXTRA_FIELD
+    #undef SINGLE
+    #undef MULTIPLE
+    #undef HOT_SINGLE
+}
+#endif
+
 Entity::Entity() {
     init();
 }
 
+#ifdef SERVERSIDE
+void Entity::attach_hot(EntityHotArrays *arrays, EntityID::id_type i) {
+    hot = arrays;
+    slot = i;
+    hot->reset(slot);
+}
+#endif
+
 void Entity::init() {
+    #ifdef SERVERSIDE
+    //not yet attached while the owning Simulation is being constructed
+    if (hot != nullptr) hot->reset(slot);
+    born = hot != nullptr ? hot->ticks_begun : 0;
+    #else
     components = 0;
     pending_delete = 0;
     lifetime = 0;
-    #define SINGLE(component, name, type) name = {};
-    #define MULTIPLE(component, name, type, amt) for (uint32_t n = 0; n < amt; ++n) { name[n] = {}; }
-    PERFIELD
+    #endif
+    #define SINGLE(component, name, type) SERVER_ONLY(release_field(name);) name = {};
+    #define MULTIPLE(component, name, type, amt) for (uint32_t n = 0; n < amt; ++n) { SERVER_ONLY(release_field(name[n]);) name[n] = {}; }
+    #define COMPONENT(name) FIELDS_##name
+    PER_INLINE_COMPONENT
+    #undef COMPONENT
     #undef SINGLE
     #undef MULTIPLE
+    #ifdef INLINE_COMPONENTS
+    #define COMPONENT(name) name##_fields.reset();
+    #else
+    //reset first so the block lets go of its strings now rather than when it is next acquired
+    #define COMPONENT(name) \
+        if (name##_fields != nullptr) { name##_fields->reset(); name##_chunks.release(name##_fields); } \
+        name##_fields = nullptr;
+    #endif
+    PER_CHUNKED_COMPONENT
+    #undef COMPONENT
     #define SINGLE(name, type, reset) name reset;
     #define MULTIPLE(name, type, amt, reset) for (uint32_t i = 0; i < amt; ++i) { name[i] reset; }
+    #define HOT_SINGLE(name, type, reset)
     PER_EXTRA_FIELD
     #undef SINGLE
     #undef MULTIPLE
+    #undef HOT_SINGLE
     reset_protocol();
 }
 
+#ifdef SERVERSIDE
+void Entity::init_from(Entity const &prefab) {
+    EntityHotArrays const &from = *prefab.hot;
+    hot->components[slot] = from.components[prefab.slot];
+    hot->pending_delete[slot] = 0;
+    #define SINGLE(component, name, type) hot->name[slot] = from.name[prefab.slot];
+    #define MULTIPLE(component, name, type, amt) for (uint32_t n = 0; n < amt; ++n) { hot->name[slot][n] = from.name[prefab.slot][n]; }
+    #define COMPONENT(name) FIELDS_##name
+    PER_HOT_COMPONENT
+    #undef COMPONENT
+    #undef SINGLE
+    #undef MULTIPLE
+    #define SINGLE(name, type, reset)
+    #define MULTIPLE(name, type, amt, reset)
+    #define HOT_SINGLE(name, type, reset) hot->name[slot] = from.name[prefab.slot];
+    PER_EXTRA_FIELD
+    #undef SINGLE
+    #undef MULTIPLE
+    #undef HOT_SINGLE
+    born = hot->ticks_begun;
+    #define SINGLE(component, name, type) retain_field(prefab.name); release_field(name); name = prefab.name;
+    #define MULTIPLE(component, name, type, amt) for (uint32_t n = 0; n < amt; ++n) { retain_field(prefab.name[n]); release_field(name[n]); name[n] = prefab.name[n]; }
+    #define COMPONENT(name) FIELDS_##name
+    PER_INLINE_COMPONENT
+    #undef COMPONENT
+    #undef SINGLE
+    #undef MULTIPLE
+    //the fields are copied as a whole, so they are retained and released one by one first
+    #define SINGLE(component, name, type) retain_field(prefab.component##_data().name); release_field(component##_data().name);
+    #define MULTIPLE(component, name, type, amt) \
+        for (uint32_t n = 0; n < amt; ++n) { retain_field(prefab.component##_data().name[n]); release_field(component##_data().name[n]); }
+    #ifdef INLINE_COMPONENTS
+    #define COMPONENT(name) FIELDS_##name name##_fields = prefab.name##_fields;
+    #else
+    #define COMPONENT(name) \
+        if (prefab.has_component(k##name)) { \
+            if (name##_fields == nullptr) name##_fields = name##_chunks.acquire(); \
+            FIELDS_##name \
+            *name##_fields = *prefab.name##_fields; \
+        } else if (name##_fields != nullptr) { \
+            name##_fields->reset(); \
+            name##_chunks.release(name##_fields); \
+            name##_fields = nullptr; \
+        }
+    #endif
+    PER_CHUNKED_COMPONENT
+    #undef COMPONENT
+    #undef SINGLE
+    #undef MULTIPLE
+    #define SINGLE(name, type, reset) name = prefab.name;
+    #define MULTIPLE(name, type, amt, reset) for (uint32_t i = 0; i < amt; ++i) { name[i] = prefab.name[i]; }
+    #define HOT_SINGLE(name, type, reset)
+    PER_EXTRA_FIELD
+    #undef SINGLE
+    #undef MULTIPLE
+    #undef HOT_SINGLE
+    uint8_t changed = 0;
+    for (uint32_t n = 0; n < div_round_up(kFieldCount, 8); ++n) changed |= (state[n] = prefab.state[n]);
+    #define SINGLE(component, name, type)
+    #define MULTIPLE(component, name, type, amt) for (uint32_t n = 0; n < div_round_up(amt, 8); ++n) { state_per_##name[n] = prefab.state_per_##name[n]; }
+    PERFIELD
+    #undef SINGLE
+    #undef MULTIPLE
+    if (changed) _mark_dirty();
+    #ifdef HOT_COUNTERS
+    for (uint32_t comp = 0; comp < kComponentCount; ++comp)
+        if (has_component(comp)) count_component_alloc(comp);
+    #endif
+}
+#endif
+
 void Entity::reset_protocol() {
     for (uint32_t n = 0; n < div_round_up(kFieldCount, 8); ++n) state[n] = 0;
     #define SINGLE(component, name, type);
@@ -33,30 +236,50 @@ void Entity::reset_protocol() {
     #undef MULTIPLE
 }
 
+//chunked components get their fields when the entity first has them
+void Entity::_attach_chunks() {
+    #ifndef INLINE_COMPONENTS
+    #define COMPONENT(name) \
+        if (has_component(k##name) && name##_fields == nullptr) name##_fields = name##_chunks.acquire();
+    PER_CHUNKED_COMPONENT
+    #undef COMPONENT
+    #endif
+}
+
 void Entity::add_component(uint32_t comp) {
     DEBUG_ONLY(assert(!has_component(comp));)
-    BIT_SET(components, comp);
+    BIT_SET(_components(), comp);
+    _attach_chunks();
+    #ifdef HOT_COUNTERS
+    count_component_alloc(comp);
+    #endif
 }
 
 uint8_t Entity::has_component(uint32_t comp) const {
-    return BIT_AT(components, comp);
+    return BIT_AT(_components(), comp);
 }
 
 #ifdef SERVERSIDE
 #define SINGLE(component, name, type) \
 void Entity::set_##name(type const &v) { \
     DEBUG_ONLY(assert(has_component(k##component));) \
-    if (name == v) return; \
-    name = v; \
+    if (component##_data().name == v) return; \
+    retain_field(v); \
+    release_field(component##_data().name); \
+    component##_data().name = v; \
     BIT_SET_ARR(state, k##name); \
+    _mark_dirty(); \
 }
 #define MULTIPLE(component, name, type, amt) \
 void Entity::set_##name(uint32_t i, type const &v) { \
     DEBUG_ONLY(assert(has_component(k##component));) \
-    if (name[i] == v) return; \
-    name[i] = v; \
+    if (component##_data().name[i] == v) return; \
+    retain_field(v); \
+    release_field(component##_data().name[i]); \
+    component##_data().name[i] = v; \
     BIT_SET_ARR(state, k##name); \
     BIT_SET_ARR(state_per_##name, i); \
+    _mark_dirty(); \
 }
 PERFIELD
 #undef SINGLE
@@ -64,12 +287,12 @@ PERFIELD
 
 template<>
 void Entity::write<true>(Writer *writer) {
-    writer->write<uint32_t>(components);
-    writer->write<uint32_t>(lifetime);
-    #define SINGLE(component, name, type) { writer->write<type>(name); }
+    writer->write<uint32_t>(_components());
+    writer->write<uint32_t>(lifetime());
+    #define SINGLE(component, name, type) { writer->write<type>(component##_data().name); }
     #define MULTIPLE(component, name, type, amt) { \
         for (uint32_t n = 0; n < amt; ++n) \
-            writer->write<type>(name[n]); \
+            writer->write<type>(component##_data().name[n]); \
     }
     #define COMPONENT(name) if (has_component(k##name)) { FIELDS_##name }
     PERCOMPONENT
@@ -83,7 +306,7 @@ void Entity::write<false>(Writer *writer) {
     #define SINGLE(component, name, type) \
         if(BIT_AT_ARR(state, k##name)) { \
             writer->write<uint8_t>(k##name); \
-            writer->write<type>(name); \
+            writer->write<type>(component##_data().name); \
     }
     #define MULTIPLE(component, name, type, amt) \
         if(BIT_AT_ARR(state, k##name)) { \
@@ -91,7 +314,43 @@ void Entity::write<false>(Writer *writer) {
             for (uint32_t n = 0; n < amt; ++n) { \
                 if (BIT_AT_ARR(state_per_##name, n)) { \
                     writer->write<uint8_t>(n); \
-                    writer->write<type>(name[n]); \
+                    writer->write<type>(component##_data().name[n]); \
+                } \
+            } \
+            writer->write<uint8_t>(amt); \
+        }
+    #define COMPONENT(name) if (has_component(k##name)) { FIELDS_##name }
+    PERCOMPONENT
+    #undef SINGLE
+    #undef MULTIPLE
+    #undef COMPONENT
+    writer->write<uint8_t>(kFieldCount);
+}
+
+void Entity::collect_state(FieldMask &mask) const {
+    for (uint32_t n = 0; n < div_round_up(kFieldCount, 8); ++n) mask.state[n] |= state[n];
+    #define SINGLE(component, name, type)
+    #define MULTIPLE(component, name, type, amt) for (uint32_t n = 0; n < div_round_up(amt, 8); ++n) { mask.state_per_##name[n] |= state_per_##name[n]; }
+    PERFIELD
+    #undef SINGLE
+    #undef MULTIPLE
+}
+
+void Entity::write_update(Writer *writer, FieldMask const &missed) {
+    FieldMask mask = missed;
+    collect_state(mask);
+    #define SINGLE(component, name, type) \
+        if(BIT_AT_ARR(mask.state, k##name)) { \
+            writer->write<uint8_t>(k##name); \
+            writer->write<type>(component##_data().name); \
+    }
+    #define MULTIPLE(component, name, type, amt) \
+        if(BIT_AT_ARR(mask.state, k##name)) { \
+            writer->write<uint8_t>(k##name); \
+            for (uint32_t n = 0; n < amt; ++n) { \
+                if (BIT_AT_ARR(mask.state_per_##name, n)) { \
+                    writer->write<uint8_t>(n); \
+                    writer->write<type>(component##_data().name[n]); \
                 } \
             } \
             writer->write<uint8_t>(amt); \
@@ -113,13 +372,14 @@ void Entity::write(Writer *writer, uint8_t create) {
 template<>
 void Entity::read<true>(Reader *reader) {
     components = reader->read<uint32_t>();
+    _attach_chunks();
     lifetime = reader->read<uint32_t>();
-    #define SINGLE(component, name, type) { reader->read<type>(name); BIT_SET_ARR(state, k##name); }
+    #define SINGLE(component, name, type) { reader->read<type>(component##_data().name); BIT_SET_ARR(state, k##name); }
     #define MULTIPLE(component, name, type, amt) { \
         BIT_SET_ARR(state, k##name); \
         for (uint32_t n = 0; n < amt; ++n) { \
             BIT_SET_ARR(state_per_##name, n); \
-            reader->read<type>(name[n]); \
+            reader->read<type>(component##_data().name[n]); \
         } \
     }
     #define COMPONENT(name) if (has_component(k##name)) { FIELDS_##name }
@@ -136,7 +396,7 @@ void Entity::read<false>(Reader *reader) {
         switch(reader->read<uint8_t>()) {
             case kFieldCount: { return; }
             #define SINGLE(component, name, type) case k##name: { \
-                reader->read<type>(name); \
+                reader->read<type>(component##_data().name); \
                 BIT_SET_ARR(state, k##name); \
                 break; \
             }
@@ -145,7 +405,7 @@ void Entity::read<false>(Reader *reader) {
                 while (1) { \
                     uint8_t index = reader->read<uint8_t>(); \
                     if (index >= amt) break; \
-                    reader->read<type>(name[index]); \
+                    reader->read<type>(component##_data().name[index]); \
                     BIT_SET_ARR(state_per_##name, index); \
                 } \
                 break; \
@@ -1,7 +1,9 @@
 #pragma once
 
+#include <Shared/ComponentChunks.hh>
 #include <Shared/EntityDef.hh>
 #include <Shared/Helpers.hh>
+#include <Shared/ReservedArray.hh>
 #include <Shared/Vector.hh>
 
 #include <cstdint>
@@ -18,6 +20,94 @@ enum Components {
     kComponentCount
 };
 
+//the fields of each chunked component, CameraData and FlowerData
+#define SINGLE(component, name, type) type name;
+#define MULTIPLE(component, name, type, amt) type name[amt];
+#define EXTRA_SINGLE(component, name, type, reset) type name;
+#define EXTRA_MULTIPLE(component, name, type, amt, reset) type name[amt];
+#define COMPONENT(name) \
+struct name##Data { \
+    FIELDS_##name \
+    EXTRA_FIELDS_##name \
+    void reset(); \
+};
+PER_CHUNKED_COMPONENT
+#undef COMPONENT
+#undef SINGLE
+#undef MULTIPLE
+#undef EXTRA_SINGLE
+#undef EXTRA_MULTIPLE
+
+#ifndef INLINE_COMPONENTS
+#define COMPONENT(name) extern ComponentChunks<name##Data> name##_chunks;
+PER_CHUNKED_COMPONENT
+#undef COMPONENT
+#endif
+
+//how many entity slots a simulation has unless the server is started with another cap
+inline uint32_t const DEFAULT_ENTITY_CAP = 8192;
+//the smallest cap a game fits in: the teams, a few players and the budget's headroom, which is
+//a quarter of the cap and has to hold the largest spawn group (a centipede or an ant hole)
+inline uint32_t const MIN_ENTITY_CAP = 256;
+//one slot per value of the id type, a larger cap needs a wider EntityID::id_type
+inline uint32_t const MAX_ENTITY_CAP = 1 << (8 * sizeof(EntityID::id_type));
+static_assert(sizeof(EntityID::id_type) < sizeof(uint32_t), "ids are counted in uint32_t");
+
+#ifdef HOT_COUNTERS
+//entity churn by component, called as entities get components and are deleted
+//the server's hot counters define them, so shared code doesn't depend on them
+void count_component_alloc(uint32_t);
+void count_component_delete(uint32_t);
+#endif
+
+#ifdef SERVERSIDE
+//the hot fields of every entity slot, one packed array per field indexed by entity id
+//a Simulation owns one and attaches its entities to it, so the per-tick sweeps can walk the
+//arrays by id without touching the Entities themselves
+//every array is reserved for the cap and committed as the simulation grows, so none of them move
+//it also keeps the bookkeeping entities report to post_tick, so post_tick only visits the ones that need it
+struct EntityHotArrays {
+    ReservedArray<uint32_t> components;
+    ReservedArray<uint8_t> pending_delete;
+    //slots with protocol state for post_tick to clear, each listed once, and whether a slot is listed
+    //a slot stays listed when its entity is deleted, the next post_tick drops it
+    ReservedArray<EntityID::id_type> dirty;
+    ReservedArray<uint8_t> listed_dirty;
+    uint32_t dirty_count = 0;
+    //pre_ticks started and post_tick countdowns run since the simulation was reset
+    //lifetimes and timers are stored as the count they start or end at instead of being counted down
+    uint32_t ticks_begun = 0;
+    uint32_t countdowns = 0;
+    #define SINGLE(component, name, type) ReservedArray<type> name;
+    #define MULTIPLE(component, name, type, amt) ReservedArray<type[amt]> name;
+    #define COMPONENT(name) FIELDS_##name
+    PER_HOT_COMPONENT
+    #undef COMPONENT
+    #undef SINGLE
+    #undef MULTIPLE
+    #define SINGLE(name, type, reset)
+    #define MULTIPLE(name, type, amt, reset)
+    #define HOT_SINGLE(name, type, reset) ReservedArray<type> name;
+    PER_EXTRA_FIELD
+    #undef SINGLE
+    #undef MULTIPLE
+    #undef HOT_SINGLE
+    void reserve(uint32_t);
+    void commit(uint32_t);
+    void reset(EntityID::id_type);
+    static uint32_t bytes_per_entity();
+};
+
+//what name##_data() returns for a hot component, references into its slot of the arrays
+#define SINGLE(component, name, type) type &name;
+#define MULTIPLE(component, name, type, amt) type (&name)[amt];
+#define COMPONENT(name) struct name##Ref { FIELDS_##name };
+PER_HOT_COMPONENT
+#undef COMPONENT
+#undef SINGLE
+#undef MULTIPLE
+#endif
+
 class Entity {
     enum Fields {
         #define SINGLE(component, name, type) k##name,
@@ -27,39 +117,154 @@ class Entity {
         #undef MULTIPLE
         kFieldCount
     };
+    #ifdef SERVERSIDE
+    EntityHotArrays *hot = nullptr;
+    EntityID::id_type slot = 0;
+    uint32_t &_components() { return hot->components[slot]; }
+    uint32_t const &_components() const { return hot->components[slot]; }
+    void _mark_dirty() {
+        if (hot->listed_dirty[slot]) return;
+        hot->listed_dirty[slot] = 1;
+        hot->dirty[hot->dirty_count++] = slot;
+    }
+    #else
     uint32_t components;
+    uint32_t &_components() { return components; }
+    uint32_t const &_components() const { return components; }
+    #endif
     uint8_t state[div_round_up(kFieldCount, 8)];
     #define SINGLE(component, name, type);
     #define MULTIPLE(component, name, type, amt) uint8_t state_per_##name[div_round_up(amt, 8)];
     PERFIELD
     #undef SINGLE
     #undef MULTIPLE
+    #ifdef INLINE_COMPONENTS
+    #define COMPONENT(name) name##Data name##_fields;
+    #else
+    #define COMPONENT(name) name##Data *name##_fields = nullptr;
+    #endif
+    PER_CHUNKED_COMPONENT
+    #undef COMPONENT
+    void _attach_chunks();
 public:
     Entity();
     void init();
+    //init() with another entity's fields in place of the reset values, state bits included
+    SERVER_ONLY(void init_from(Entity const &);)
     void reset_protocol();
     Entity(Entity const &) = delete;
     Entity &operator=(Entity const &) = delete;
-    uint32_t lifetime;
+    SERVER_ONLY(void attach_hot(EntityHotArrays *, EntityID::id_type);)
+    //the pre_tick the entity spawned during or after
+    SERVER_ONLY(uint32_t born;)
+    CLIENT_ONLY(uint32_t lifetime;)
     EntityID id;
-    uint8_t pending_delete;
+    CLIENT_ONLY(uint8_t pending_delete;)
 #define SINGLE(component, name, type) type name;
 #define MULTIPLE(component, name, type, amt) type name[amt];
-PERFIELD
+#define COMPONENT(name) FIELDS_##name
+PER_INLINE_COMPONENT
+#undef COMPONENT
+#undef SINGLE
+#undef MULTIPLE
+//name##_data() reaches any component's fields, which is how code generated over PERFIELD stays
+//the same whichever way a component is stored
+#define COMPONENT(name) \
+    Entity &name##_data() { return *this; } \
+    Entity const &name##_data() const { return *this; }
+PER_INLINE_COMPONENT
+#undef COMPONENT
+#ifdef INLINE_COMPONENTS
+#define COMPONENT(name) \
+    name##Data &name##_data() { return name##_fields; } \
+    name##Data const &name##_data() const { return name##_fields; }
+#else
+#define COMPONENT(name) \
+    name##Data &name##_data() { DEBUG_ONLY(assert(name##_fields != nullptr);) return *name##_fields; } \
+    name##Data const &name##_data() const { DEBUG_ONLY(assert(name##_fields != nullptr);) return *name##_fields; }
+#endif
+PER_CHUNKED_COMPONENT
+#undef COMPONENT
+#ifdef SERVERSIDE
+#define SINGLE(component, name, type) hot->name[slot],
+#define MULTIPLE(component, name, type, amt) hot->name[slot],
+#define COMPONENT(name) name##Ref name##_data() const { return { FIELDS_##name }; }
+PER_HOT_COMPONENT
+#undef COMPONENT
+#undef SINGLE
+#undef MULTIPLE
+//mark_##name() flags a field as changed for kernels that write the packed arrays directly
+#define SINGLE(component, name, type) \
+    type &name() { return hot->name[slot]; } \
+    type const &name() const { return hot->name[slot]; } \
+    void mark_##name() { BIT_SET_ARR(state, k##name); _mark_dirty(); }
+#define MULTIPLE(component, name, type, amt) \
+    type &name(uint32_t i) { return hot->name[slot][i]; } \
+    type const &name(uint32_t i) const { return hot->name[slot][i]; }
+#define COMPONENT(name) FIELDS_##name
+PER_HOT_COMPONENT
+#undef COMPONENT
 #undef SINGLE
 #undef MULTIPLE
+#define SINGLE(name, type, reset)
+#define MULTIPLE(name, type, amt, reset)
+#define HOT_SINGLE(name, type, reset) \
+    type &name() { return hot->name[slot]; } \
+    type const &name() const { return hot->name[slot]; }
+PER_EXTRA_FIELD
+#undef SINGLE
+#undef MULTIPLE
+#undef HOT_SINGLE
+uint8_t &pending_delete() { return hot->pending_delete[slot]; }
+uint8_t const &pending_delete() const { return hot->pending_delete[slot]; }
+//post_tick only counts entities that were there when the tick began, so one spawned mid tick
+//is a countdown behind until the next post_tick
+uint32_t lifetime() const { return born > hot->countdowns ? 0 : hot->countdowns - born; }
+//the countdown that next counts the entity, timers measured from it match counting down in post_tick
+uint32_t next_countdown() const { return hot->countdowns + 1 + (born > hot->countdowns); }
+#endif
+#define SINGLE(component, name, type) \
+    type &name() { return component##_data().name; } \
+    type const &name() const { return component##_data().name; }
+#define MULTIPLE(component, name, type, amt) \
+    type &name(uint32_t i) { return component##_data().name[i]; } \
+    type const &name(uint32_t i) const { return component##_data().name[i]; }
+#define EXTRA_SINGLE(component, name, type, reset) SINGLE(component, name, type)
+#define EXTRA_MULTIPLE(component, name, type, amt, reset) MULTIPLE(component, name, type, amt)
+#define COMPONENT(name) FIELDS_##name EXTRA_FIELDS_##name
+PER_CHUNKED_COMPONENT
+#undef COMPONENT
+#undef SINGLE
+#undef MULTIPLE
+#undef EXTRA_SINGLE
+#undef EXTRA_MULTIPLE
 void add_component(uint32_t);
 uint8_t has_component(uint32_t) const;
 #define SINGLE(name, type, reset) type name;
 #define MULTIPLE(name, type, amt, reset) type name[amt];
+#define HOT_SINGLE(name, type, reset)
 PER_EXTRA_FIELD
 #undef SINGLE
 #undef MULTIPLE
+#undef HOT_SINGLE
 #ifdef SERVERSIDE
     void write(Writer *, uint8_t);
 
     template<bool>
     void write(Writer *);
+    //state bits gathered over several ticks, what a client keeps while it misses updates
+    struct FieldMask {
+        uint8_t state[div_round_up(kFieldCount, 8)];
+        #define SINGLE(component, name, type)
+        #define MULTIPLE(component, name, type, amt) uint8_t state_per_##name[div_round_up(amt, 8)];
+        PERFIELD
+        #undef SINGLE
+        #undef MULTIPLE
+    };
+    //adds this tick's state bits to the mask
+    void collect_state(FieldMask &) const;
+    //an update record for the fields changed this tick or in the mask
+    void write_update(Writer *, FieldMask const &);
     #define SINGLE(component, name, type) void set_##name(type const &);
     #define MULTIPLE(component, name, type, amt) void set_##name(uint32_t, type const &);
     PERFIELD
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <Shared/StaticDefinitions.hh>
+#include <Shared/StringTable.hh>
 
 #include <cstdint>
 
@@ -20,6 +21,47 @@ typedef uint16_t game_tick_t;
     COMPONENT(Score) \
     COMPONENT(Name)
 
+//PERCOMPONENT split by where the fields are stored, the order of PERCOMPONENT is the protocol's
+//hot components are read by every per-tick sweep (the spatial hash, culling, collision, motion), so
+//the server keeps their fields in Simulation::hot, one packed array per field indexed by entity id,
+//and reaches them through accessors, ent.x() or ent.team(). the client keeps them inline
+//chunked components are only on a handful of entities (players), so their fields live in
+//ComponentChunks instead of every Entity and are reached through accessors, ent.player() or
+//ent.inventory(i). building with INLINE_COMPONENTS embeds them in Entity again
+#ifdef SERVERSIDE
+#define PER_HOT_COMPONENT \
+    COMPONENT(Physics) \
+    COMPONENT(Relations)
+
+#define PER_INLINE_COMPONENT \
+    COMPONENT(Petal) \
+    COMPONENT(Health) \
+    COMPONENT(Mob) \
+    COMPONENT(Drop) \
+    COMPONENT(Segmented) \
+    COMPONENT(Web) \
+    COMPONENT(Score) \
+    COMPONENT(Name)
+#else
+#define PER_HOT_COMPONENT
+
+#define PER_INLINE_COMPONENT \
+    COMPONENT(Physics) \
+    COMPONENT(Relations) \
+    COMPONENT(Petal) \
+    COMPONENT(Health) \
+    COMPONENT(Mob) \
+    COMPONENT(Drop) \
+    COMPONENT(Segmented) \
+    COMPONENT(Web) \
+    COMPONENT(Score) \
+    COMPONENT(Name)
+#endif
+
+#define PER_CHUNKED_COMPONENT \
+    COMPONENT(Camera) \
+    COMPONENT(Flower)
+
 #define PERFIELD \
 FIELDS_Physics \
 FIELDS_Camera \
@@ -43,7 +85,7 @@ SINGLE(Physics, angle, Float)
 SINGLE(Camera, player, EntityID) \
 SINGLE(Camera, respawn_level, uint8_t) \
 MULTIPLE(Camera, inventory, PetalID::T, 2 * MAX_SLOT_COUNT) \
-SINGLE(Camera, killed_by, std::string) \
+SINGLE(Camera, killed_by, StringID) \
 SINGLE(Camera, camera_x, Float) \
 SINGLE(Camera, camera_y, Float) \
 SINGLE(Camera, fov, Float) 
@@ -83,25 +125,25 @@ SINGLE(Segmented, is_tail, uint8_t)
 SINGLE(Score, score, uint32_t)
 
 #define FIELDS_Name \
-SINGLE(Name, name, std::string) \
+SINGLE(Name, name, StringID) \
 SINGLE(Name, nametag_visible, uint8_t)
 
 #ifdef SERVERSIDE
+//HOT_SINGLE fields are stored in Simulation::hot alongside the hot components' fields
 #define PER_EXTRA_FIELD \
-    SINGLE(velocity, Vector, .set(0,0)) \
-    SINGLE(collision_velocity, Vector, .set(0,0)) \
-    SINGLE(acceleration, Vector, .set(0,0)) \
-    SINGLE(friction, float, =0) \
-    SINGLE(mass, float, =1) \
-    SINGLE(speed_ratio, float, =1) \
+    HOT_SINGLE(velocity, Vector, .set(0,0)) \
+    HOT_SINGLE(collision_velocity, Vector, .set(0,0)) \
+    HOT_SINGLE(acceleration, Vector, .set(0,0)) \
+    HOT_SINGLE(friction, float, =0) \
+    HOT_SINGLE(mass, float, =1) \
+    HOT_SINGLE(speed_ratio, float, =1) \
     \
-    MULTIPLE(loadout, LoadoutSlot, MAX_SLOT_COUNT, .reset()) \
     SINGLE(heading_angle, float, =0) \
     SINGLE(input, uint8_t, =0) \
     \
-    SINGLE(slow_ticks, game_tick_t, =0) \
+    HOT_SINGLE(slow_ticks, game_tick_t, =0) \
     SINGLE(slow_inflict, game_tick_t, =0) \
-    SINGLE(immunity_ticks, game_tick_t, =0) \
+    SINGLE(immune_until, uint32_t, =0) \
     SINGLE(dandy_ticks, game_tick_t, =0) \
     SINGLE(poison_ticks, game_tick_t, =0) \
     SINGLE(poison_inflicted, float, =0) \
@@ -124,11 +166,17 @@ SINGLE(Name, nametag_visible, uint8_t)
     SINGLE(ai_state, uint8_t, =0) \
     \
     SINGLE(zone, uint8_t, =0) \
-    SINGLE(flags, uint8_t, =0) \
-    SINGLE(deletion_tick, uint8_t, =0) \
-    SINGLE(despawn_tick, game_tick_t, =0) \
-    SINGLE(secondary_reload, game_tick_t, =0) \
-    SINGLE(deleted_petals, circ_arr_t, ={})
+    SINGLE(budget_category, uint8_t, =0) \
+    HOT_SINGLE(flags, uint8_t, =0) \
+    SINGLE(died_at, uint32_t, =0) \
+    SINGLE(despawn_at, uint32_t, =0) \
+    SINGLE(secondary_reload, game_tick_t, =0)
+
+//server state that only flowers have, stored alongside their chunked fields
+#define EXTRA_FIELDS_Camera
+#define EXTRA_FIELDS_Flower \
+    EXTRA_MULTIPLE(Flower, loadout, LoadoutSlot, MAX_SLOT_COUNT, .reset()) \
+    EXTRA_SINGLE(Flower, deleted_petals, circ_arr_t, ={})
 #else
 #define PER_EXTRA_FIELD \
     SINGLE(last_damaged_time, double, =0) \
@@ -140,6 +188,9 @@ SINGLE(Name, nametag_visible, uint8_t)
     SINGLE(mouth, float, =15) \
     SINGLE(animation, float, =0) \
     SINGLE(damage_flash, float, =0)
+
+#define EXTRA_FIELDS_Camera
+#define EXTRA_FIELDS_Flower
 #endif
 
 class EntityID {
@@ -155,6 +206,9 @@ public:
     bool null() const;
 };
 
+//make_hash packs the id above 16 bits of hash, wider types need a wider key
+static_assert(sizeof(EntityID::hash_type) <= 2 && sizeof(EntityID::id_type) <= 2);
+
 bool operator<(EntityID const, EntityID const);
 bool operator==(EntityID const, EntityID const);
 
@@ -9,8 +9,59 @@ float fclamp(float v, float s, float e) {
     return v;
 }
 
+static uint64_t _splitmix64(uint64_t &x) {
+    uint64_t z = (x += 0x9e3779b97f4a7c15ull);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+    return z ^ (z >> 31);
+}
+
+static uint64_t _rotl(uint64_t x, int k) {
+    return (x << k) | (x >> (64 - k));
+}
+
+Rng::Rng(uint64_t s, uint64_t stream) {
+    seed(s, stream);
+}
+
+void Rng::seed(uint64_t s, uint64_t stream) {
+    uint64_t x = s ^ _splitmix64(stream);
+    for (uint32_t i = 0; i < 4; ++i) state[i] = _splitmix64(x);
+}
+
+uint64_t Rng::next() {
+    uint64_t ret = _rotl(state[1] * 5, 7) * 9;
+    uint64_t t = state[1] << 17;
+    state[2] ^= state[0];
+    state[3] ^= state[1];
+    state[1] ^= state[2];
+    state[0] ^= state[3];
+    state[2] ^= t;
+    state[3] = _rotl(state[3], 45);
+    return ret;
+}
+
+double Rng::next_double() {
+    return (next() >> 11) * 0x1.0p-53;
+}
+
+static Rng process_rng;
+static thread_local Rng *bound_rng = &process_rng;
+
+RngScope::RngScope(Rng &rng) : prev(bound_rng) {
+    bound_rng = &rng;
+}
+
+RngScope::~RngScope() {
+    bound_rng = prev;
+}
+
+void seed_rng(uint64_t s) {
+    process_rng.seed(s);
+}
+
 double frand() {
-    return std::rand() / (double) RAND_MAX;
+    return bound_rng->next_double();
 }
 
 
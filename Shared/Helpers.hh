@@ -4,6 +4,8 @@
 #include <cstdint>
 #include <format>
 #include <string>
+#include <type_traits>
+#include <utility>
 
 #ifndef M_PI
     #define M_PI 3.14159265358979323846
@@ -42,6 +44,26 @@ constexpr uint32_t div_round_up(uint32_t a, uint32_t b) { return (a + b - 1) / b
 #define LERP(result, from, amt) { result = lerp(result, from, amt); }
 #define ANGLE_LERP(result, from, amt) { result = angle_lerp(result, from, amt); }
 
+//xoshiro256**, seeded through splitmix64 so neighbouring seeds and streams are unrelated
+class Rng {
+    uint64_t state[4];
+public:
+    Rng(uint64_t = 0, uint64_t = 0);
+    void seed(uint64_t, uint64_t = 0);
+    uint64_t next();
+    //uniform in [0, 1)
+    double next_double();
+};
+
+//frand draws from the stream bound on the calling thread, or the process-wide stream if none is
+class RngScope {
+    Rng *prev;
+public:
+    RngScope(Rng &);
+    ~RngScope();
+};
+
+void seed_rng(uint64_t);
 double frand();
 float fclamp(float, float, float);
 float lerp(float, float, float);
@@ -65,6 +87,7 @@ public:
     constexpr uint32_t size() const { return length; };
     constexpr void push(T val) { DEBUG_ONLY(assert(length < capacity); ) values[length++] = val; };
     constexpr T pop() { DEBUG_ONLY(assert(length > 0); ) return std::move(values[--length]); };
+    constexpr T &back() { DEBUG_ONLY(assert(length > 0); ) return values[length - 1]; };
     constexpr void clear() { length = 0; }
     constexpr T *begin() { return &values[0]; };
     constexpr T *end() { return &values[length]; };
@@ -72,6 +95,30 @@ public:
     constexpr T const *end() const { return &values[length]; };
 };
 
+//a callback that is only called while the call it was passed to runs
+//refers to the callable instead of copying it, so unlike std::function it never allocates
+template<typename T>
+class FunctionRef;
+
+template<typename R, typename ...Args>
+class FunctionRef<R(Args...)> {
+    void const *callable;
+    R (*trampoline)(void const *, Args...);
+public:
+    template<typename F>
+    FunctionRef(F const &f) : callable(reinterpret_cast<void const *>(&f)) {
+        if constexpr (std::is_function_v<F>)
+            trampoline = [](void const *fn, Args ...args) -> R {
+                return reinterpret_cast<F *>(const_cast<void *>(fn))(std::forward<Args>(args)...);
+            };
+        else
+            trampoline = [](void const *fn, Args ...args) -> R {
+                return (*static_cast<F const *>(fn))(std::forward<Args>(args)...);
+            };
+    }
+    R operator()(Args ...args) const { return trampoline(callable, std::forward<Args>(args)...); }
+};
+
 template<typename T, uint32_t max_len>
 class CircularArray {
     T values[max_len];
@@ -104,6 +151,15 @@ public:
     constexpr void clear() { start = length = 0; };
 };
 
+#ifdef SERVERSIDE
+//called on each value a field takes and gives up, a field type that holds a reference to
+//something, like a StringID, overloads them to count its copies
+template<typename T>
+void retain_field(T const &) {}
+template<typename T>
+void release_field(T const &) {}
+#endif
+
 class LerpFloat {
     float value;
     float lerp_value;
@@ -1,6 +1,7 @@
 #include <Shared/Map.hh>
 
 #ifdef SERVERSIDE
+#include <Server/EntityFunctions.hh>
 #include <Server/Spawn.hh>
 #include <Shared/Entity.hh>
 #include <Shared/Helpers.hh>
@@ -27,9 +28,9 @@ uint32_t Map::get_zone_from_pos(float x, float y) {
 }
 
 uint32_t Map::get_suitable_difficulty_zone(uint32_t power) {
-    std::vector<uint32_t> possible_zones;
+    StaticArray<uint32_t, MAP.size()> possible_zones;
     for (uint32_t i = 0; i < MAP.size(); ++i)
-        if (MAP[i].difficulty == power) possible_zones.push_back(i);
+        if (MAP[i].difficulty == power) possible_zones.push(i);
     if (possible_zones.size() == 0) return 0;
     return possible_zones[frand() * possible_zones.size()];
 }
@@ -42,6 +43,7 @@ void Map::remove_mob(Simulation *sim, uint32_t zone) {
 }
 
 void Map::spawn_random_mob(Simulation *sim) {
+    if (!sim->budget.can_spawn_zone_mob()) return;
     float x = frand() * ARENA_WIDTH;
     float y = frand() * ARENA_HEIGHT;
     uint32_t zone_id = Map::get_zone_from_pos(x, y);
@@ -54,10 +56,12 @@ void Map::spawn_random_mob(Simulation *sim) {
     for (SpawnChance const &s : zone.spawns) {
         sum -= s.chance;
         if (sum <= 0) {
+            //the whole group has to fit, an ant hole or a centipede is several entities
+            if (!sim->budget.can_spawn(BudgetCategory::kZoneMob, mob_entity_count(s.id))) return;
             Entity &ent = alloc_mob(sim, s.id, x, y, NULL_ENTITY);
             ent.zone = zone_id;
-            ent.immunity_ticks = TPS;
-            BIT_SET(ent.flags, EntityFlags::kSpawnedFromZone);
+            entity_set_immunity(ent, TPS);
+            BIT_SET(ent.flags(), EntityFlags::kSpawnedFromZone);
             sim->zone_mob_counts[zone_id]++;
             return;
         }
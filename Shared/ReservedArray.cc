@@ -0,0 +1,65 @@
+#include <Shared/ReservedArray.hh>
+
+#include <cassert>
+#include <cstdlib>
+
+#ifdef __EMSCRIPTEN__
+//linear memory can't be reserved without being allocated
+void *VirtualMemory::reserve(size_t size) {
+    void *ptr = std::calloc(size == 0 ? 1 : size, 1);
+    assert(ptr != nullptr);
+    return ptr;
+}
+
+void VirtualMemory::commit(void *, size_t) {}
+
+void VirtualMemory::release(void *ptr, size_t) {
+    std::free(ptr);
+}
+#elif defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+
+//windows rounds both to whole pages itself
+void *VirtualMemory::reserve(size_t size) {
+    void *ptr = VirtualAlloc(nullptr, size == 0 ? 1 : size, MEM_RESERVE, PAGE_NOACCESS);
+    assert(ptr != nullptr);
+    return ptr;
+}
+
+void VirtualMemory::commit(void *ptr, size_t size) {
+    if (size == 0) return;
+    void *ret = VirtualAlloc(ptr, size, MEM_COMMIT, PAGE_READWRITE);
+    assert(ret != nullptr);
+    (void) ret;
+}
+
+void VirtualMemory::release(void *ptr, size_t) {
+    VirtualFree(ptr, 0, MEM_RELEASE);
+}
+#else
+#include <sys/mman.h>
+#include <unistd.h>
+
+static size_t _page_round(size_t size) {
+    static size_t const page = sysconf(_SC_PAGESIZE);
+    return (size + page - 1) / page * page;
+}
+
+void *VirtualMemory::reserve(size_t size) {
+    void *ptr = mmap(nullptr, _page_round(size == 0 ? 1 : size), PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    assert(ptr != MAP_FAILED);
+    return ptr;
+}
+
+void VirtualMemory::commit(void *ptr, size_t size) {
+    int ret = mprotect(ptr, _page_round(size), PROT_READ | PROT_WRITE);
+    assert(ret == 0);
+    (void) ret;
+}
+
+void VirtualMemory::release(void *ptr, size_t size) {
+    munmap(ptr, _page_round(size == 0 ? 1 : size));
+}
+#endif
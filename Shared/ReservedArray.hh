@@ -0,0 +1,61 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <type_traits>
+
+namespace VirtualMemory {
+    //address space only, touching it faults until it is committed
+    void *reserve(size_t);
+    //backs the first bytes of a reservation with memory, reads as zero until written
+    void commit(void *, size_t);
+    void release(void *, size_t);
+};
+
+//an array whose address range is reserved for its largest size up front and backed by memory only
+//as far as it has grown, so it never moves and references into it stay valid while it grows
+//where there is no virtual memory to reserve (wasm) the whole reservation is allocated at once
+template<typename T>
+class ReservedArray {
+    T *values;
+    uint32_t reserved;
+    uint32_t committed;
+public:
+    ReservedArray() : values(nullptr), reserved(0), committed(0) {}
+    ReservedArray(ReservedArray const &) = delete;
+    ReservedArray &operator=(ReservedArray const &) = delete;
+    ~ReservedArray() { release(); }
+
+    void reserve(uint32_t count) {
+        release();
+        values = static_cast<T *>(VirtualMemory::reserve(count * sizeof(T)));
+        reserved = count;
+    }
+
+    //constructs elements up to count, the ones already there are left alone
+    void commit(uint32_t count) {
+        if (count <= committed) return;
+        if (count > reserved) count = reserved;
+        VirtualMemory::commit(values, count * sizeof(T));
+        if constexpr (!std::is_trivially_default_constructible_v<T>)
+            for (uint32_t i = committed; i < count; ++i) new (&values[i]) T();
+        committed = count;
+    }
+
+    void release() {
+        if (values == nullptr) return;
+        if constexpr (!std::is_trivially_destructible_v<T>)
+            for (uint32_t i = 0; i < committed; ++i) values[i].~T();
+        VirtualMemory::release(values, reserved * sizeof(T));
+        values = nullptr;
+        reserved = committed = 0;
+    }
+
+    T &operator[](uint32_t at) { return values[at]; }
+    T const &operator[](uint32_t at) const { return values[at]; }
+    T *data() { return values; }
+    T const *data() const { return values; }
+    uint32_t capacity() const { return reserved; }
+    uint32_t size() const { return committed; }
+};
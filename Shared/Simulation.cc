@@ -1,6 +1,8 @@
 #include <Shared/Simulation.hh>
 #include <Shared/Helpers.hh>
 
+#include <algorithm>
+
 #ifdef DEBUG
 #include <iostream>
 
@@ -9,13 +11,68 @@ std::ostream &operator<<(std::ostream &out, EntityID const &id) {
 }
 #endif
 
-Simulation::Simulation() SERVER_ONLY(: spatial_hash(this)) {
+//slots are committed this many at a time at first, then the committed range doubles
+static uint32_t const MIN_COMMIT = 1024;
+
+Simulation::Simulation() : cap(0), capacity(0), live_count(0), first_free(1), active_count(0) SERVER_ONLY(, deletion_count(0), spatial_hash(this), budget(this)) {
+    reserve(DEFAULT_ENTITY_CAP);
+}
+
+void Simulation::reserve(uint32_t _cap) {
+    //id 0 is never handed out, so a cap of 1 has no room for anything
+    assert(_cap >= MIN_ENTITY_CAP && _cap <= MAX_ENTITY_CAP);
+    if (_cap == cap) return;
+    //gives chunked component blocks back before the entities holding them go
+    if (capacity > 0) reset();
+    cap = _cap;
+    capacity = 0;
+    entity_tracker.reserve(div_round_up(cap, 8));
+    hash_tracker.reserve(cap);
+    entities.reserve(cap);
+    active_entities.reserve(cap);
+    #ifdef SERVERSIDE
+    hot.reserve(cap);
+    spatial_hash.reserve(cap);
+    timers.reserve(cap);
+    deletions.reserve(cap);
+    #endif
+    _grow();
     reset();
 }
 
+//fresh slots come out of the commit zeroed, which is the same as a reset
+void Simulation::_grow() {
+    uint32_t old_capacity = capacity;
+    capacity = std::min(cap, std::max(MIN_COMMIT, 2 * capacity));
+    entity_tracker.commit(div_round_up(capacity, 8));
+    hash_tracker.commit(capacity);
+    active_entities.commit(capacity);
+    #ifdef SERVERSIDE
+    hot.commit(capacity);
+    spatial_hash.commit(capacity);
+    timers.commit(capacity);
+    deletions.commit(capacity);
+    #endif
+    entities.commit(capacity);
+    #ifdef SERVERSIDE
+    for (uint32_t i = old_capacity; i < capacity; ++i)
+        entities[i].attach_hot(&hot, i);
+    #endif
+}
+
 void Simulation::reset() {
-    active_entities.clear();
-    for (EntityID::id_type i = 0; i < ENTITY_CAP; ++i) { 
+    active_count = 0;
+    live_count = 0;
+    first_free = 1;
+    #ifdef SERVERSIDE
+    //before the entities are reset, which stamps them with the tick count
+    hot.ticks_begun = hot.countdowns = 0;
+    for (uint32_t i = 0; i < hot.dirty_count; ++i) hot.listed_dirty[hot.dirty[i]] = 0;
+    hot.dirty_count = 0;
+    deletion_count = 0;
+    timers.clear();
+    #endif
+    for (uint32_t i = 0; i < capacity; ++i) { 
         hash_tracker[i] = 0;
         BIT_UNSET_ARR(entity_tracker, i);
         entities[i].init();
@@ -23,6 +80,7 @@ void Simulation::reset() {
     arena_info.init();
     #ifdef SERVERSIDE
     spatial_hash.refresh(ARENA_WIDTH, ARENA_HEIGHT);
+    budget.reset();
     for (PetalID::T i = 0; i < PetalID::kNumPetals; ++i)
         petal_count_tracker[i] = 0;
     for (uint32_t i = 0; i < MAP.size(); ++i)
@@ -30,65 +88,134 @@ void Simulation::reset() {
     #endif
 }
 
-Entity &Simulation::alloc_ent() {
-    for (EntityID::id_type i = 1; i < ENTITY_CAP; ++i) {
-        if (BIT_AT_ARR(entity_tracker, i)) continue;
-        BIT_SET_ARR(entity_tracker, i);
-        entities[i].init();
-        DEBUG_ONLY(std::cout << "ent_create " << EntityID(i, hash_tracker[i]) << "\n";)
-        entities[i].id = EntityID(i, hash_tracker[i]);
-        return entities[i];
+uint32_t Simulation::entity_cap() const {
+    return cap;
+}
+
+uint32_t Simulation::committed_slots() const {
+    return capacity;
+}
+
+uint32_t Simulation::free_slots() const {
+    return cap - 1 - live_count;
+}
+
+//the lowest free id, as it always has been, so ids come out the same in a replay
+EntityID::id_type Simulation::_claim_slot() {
+    uint32_t i = first_free;
+    while (1) {
+        for (; i < capacity; ++i) {
+            //eight taken slots at a time
+            if ((i & 7) == 0 && entity_tracker[i >> 3] == 0xff) {
+                i += 7;
+                continue;
+            }
+            if (BIT_AT_ARR(entity_tracker, i)) continue;
+            first_free = i + 1;
+            BIT_SET_ARR(entity_tracker, i);
+            ++live_count;
+            DEBUG_ONLY(std::cout << "ent_create " << EntityID(i, hash_tracker[i]) << "\n";)
+            return i;
+        }
+        assert(capacity < cap && "Entity cap reached");
+        _grow();
     }
-    assert(!"Entity cap reached");
 }
 
+Entity &Simulation::alloc_ent() {
+    EntityID::id_type i = _claim_slot();
+    entities[i].init();
+    entities[i].id = EntityID(i, hash_tracker[i]);
+    return entities[i];
+}
+
+#ifdef SERVERSIDE
+Entity &Simulation::alloc_ent(Entity const &prefab) {
+    EntityID::id_type i = _claim_slot();
+    entities[i].init_from(prefab);
+    entities[i].id = EntityID(i, hash_tracker[i]);
+    return entities[i];
+}
+#endif
+
 Entity &Simulation::get_ent(EntityID const &id) {
     DEBUG_ONLY(assert(ent_exists(id));)
     return entities[id.id];
 }
 
+#ifdef SERVERSIDE
+//by slot, for sweeps over the packed arrays that only carry ids
+Entity &Simulation::get_ent_at(EntityID::id_type id) {
+    DEBUG_ONLY(assert(BIT_AT_ARR(entity_tracker, id));)
+    return entities[id];
+}
+
+//the ids pre_tick found, ascending, what for_each walks
+std::span<EntityID::id_type const> Simulation::active_ids() const {
+    return { active_entities.data(), active_count };
+}
+#endif
+
 void Simulation::force_alloc_ent(EntityID const &id) {
-    assert(id.id < ENTITY_CAP);
+    assert(id.id < cap);
     DEBUG_ONLY(std::cout << "ent_create " << id << "\n";)
+    while (id.id >= capacity) _grow();
     assert(!BIT_AT_ARR(entity_tracker, id.id));
     entities[id.id].init();
     BIT_SET_ARR(entity_tracker, id.id);
+    ++live_count;
     hash_tracker[id.id] = id.hash;
     entities[id.id].id = id;
 }
 
 uint8_t Simulation::ent_exists(EntityID const &id) const {
-    DEBUG_ONLY(assert(id.id < ENTITY_CAP);)
-    return BIT_AT_ARR(entity_tracker, id.id) && hash_tracker[id.id] == id.hash;
+    DEBUG_ONLY(assert(id.id < cap);)
+    return id.id < capacity && BIT_AT_ARR(entity_tracker, id.id) && hash_tracker[id.id] == id.hash;
 }
 
 uint8_t Simulation::ent_alive(EntityID const &id) const {
-    return ent_exists(id) && !entities[id.id].pending_delete
-    SERVER_ONLY(&& entities[id.id].deletion_tick == 0);
+    #ifdef SERVERSIDE
+    return ent_exists(id) && !hot.pending_delete[id.id] && entities[id.id].died_at == 0;
+    #else
+    return ent_exists(id) && !entities[id.id].pending_delete;
+    #endif
 }
 
 void Simulation::request_delete(EntityID const &id) {
     DEBUG_ONLY(assert(ent_exists(id)));
+    #ifdef SERVERSIDE
+    if (hot.pending_delete[id.id]) return;
+    hot.pending_delete[id.id] = 1;
+    deletions[deletion_count++] = id.id;
+    #else
     entities[id.id].pending_delete = 1;
+    #endif
 }
 
 void Simulation::_delete_ent(EntityID const &id) {
     DEBUG_ONLY(std::cout << "ent_delete " << id << "\n";)
     DEBUG_ONLY(assert(ent_exists(id)));
+    #ifdef HOT_COUNTERS
+    for (uint32_t i = 0; i < kComponentCount; ++i)
+        if (entities[id.id].has_component(i)) count_component_delete(i);
+    #endif
     BIT_UNSET_ARR(entity_tracker, id.id);
     hash_tracker[id.id]++;
+    --live_count;
+    if (id.id < first_free) first_free = id.id;
 }
 
 void Simulation::pre_tick() {
-    active_entities.clear();
-    for (EntityID::id_type i = 1; i < ENTITY_CAP; ++i) {
+    SERVER_ONLY(++hot.ticks_begun;)
+    active_count = 0;
+    for (uint32_t i = 1; i < capacity; ++i) {
         if (!BIT_AT_ARR(entity_tracker, i)) continue;
-        active_entities.push(entities[i].id.id);
+        active_entities[active_count++] = i;
     }
 }
 
-void Simulation::for_each_entity(std::function<void(Simulation *, Entity &)> cb) { \
-    for (EntityID::id_type i = 0; i < active_entities.size(); ++i) { \
+void Simulation::for_each_entity(FunctionRef<void(Simulation *, Entity &)> cb) { \
+    for (uint32_t i = 0; i < active_count; ++i) { \
         Entity &ent = entities[active_entities[i]]; \
         cb(this, ent); \
     } \
@@ -96,11 +223,13 @@ void Simulation::for_each_entity(std::function<void(Simulation *, Entity &)> cb)
 
 #define COMPONENT(name) \
 template<> \
-void Simulation::for_each<k##name>(std::function<void(Simulation *, Entity &)> cb) { \
-    for (EntityID::id_type i = 0; i < active_entities.size(); ++i) { \
-        Entity &ent = entities[active_entities[i]]; \
-        SERVER_ONLY(if (ent.pending_delete) continue;) \
-        if (ent.has_component(k##name)) cb(this, ent); \
+void Simulation::for_each<k##name>(FunctionRef<void(Simulation *, Entity &)> cb) { \
+    for (uint32_t i = 0; i < active_count; ++i) { \
+        EntityID::id_type id = active_entities[i]; \
+        SERVER_ONLY(if (!BIT_AT(hot.components[id], k##name) || hot.pending_delete[id]) continue;) \
+        Entity &ent = entities[id]; \
+        CLIENT_ONLY(if (!ent.has_component(k##name)) continue;) \
+        cb(this, ent); \
     } \
 }
 PERCOMPONENT
@@ -5,40 +5,69 @@
 #include <Shared/Helpers.hh>
 
 #ifdef SERVERSIDE
+#include <Server/EntityBudget.hh>
+#include <Server/TimingWheel.hh>
 #include <Server/SpatialHash.hh>
 #endif
 
-#include <functional>
+#include <span>
 #include <string>
 
-inline uint32_t const ENTITY_CAP = 8192;
-
 class Simulation {
-    uint8_t entity_tracker[div_round_up(ENTITY_CAP, 8)];
-    EntityID::hash_type hash_tracker[ENTITY_CAP];
-    Entity entities[ENTITY_CAP];
-    StaticArray<EntityID::id_type, ENTITY_CAP> active_entities;
+    //ids are handed out below cap, memory is committed for the slots below capacity
+    uint32_t cap;
+    uint32_t capacity;
+    uint32_t live_count;
+    //no slot below it is free, so looking for one starts there
+    uint32_t first_free;
+    ReservedArray<uint8_t> entity_tracker;
+    ReservedArray<EntityID::hash_type> hash_tracker;
+    ReservedArray<Entity> entities;
+    ReservedArray<EntityID::id_type> active_entities;
+    uint32_t active_count;
+    //pending deletions that haven't been through post_tick yet, or whose death animation has ended
+    //in the order they were asked for, each id once
+    SERVER_ONLY(ReservedArray<EntityID::id_type> deletions;)
+    SERVER_ONLY(uint32_t deletion_count;)
+    void _grow();
+    EntityID::id_type _claim_slot();
+    SERVER_ONLY(void _clear_dirty();)
+    SERVER_ONLY(void _run_deletions();)
 public:
+    SERVER_ONLY(EntityHotArrays hot;)
     SERVER_ONLY(uint32_t petal_count_tracker[PetalID::kNumPetals];)
     SERVER_ONLY(uint32_t zone_mob_counts[MAP.size()];)
     SERVER_ONLY(SpatialHash spatial_hash;)
+    SERVER_ONLY(EntityBudget budget;)
+    SERVER_ONLY(TimingWheel timers;)
+    SERVER_ONLY(Rng rng;)
     Arena arena_info;
     Simulation();
+    //drops every entity if the cap changes
+    void reserve(uint32_t);
     void reset();
+    uint32_t entity_cap() const;
+    //slots with memory behind them, grows toward the cap as ids are handed out
+    uint32_t committed_slots() const;
+    uint32_t free_slots() const;
     Entity &alloc_ent();
+    //starts the new entity as a copy of the prefab
+    SERVER_ONLY(Entity &alloc_ent(Entity const &);)
     void _delete_ent(EntityID const &); //DANGEROUS
     void force_alloc_ent(EntityID const &);
     void request_delete(EntityID const &);
     Entity &get_ent(EntityID const &);
+    SERVER_ONLY(Entity &get_ent_at(EntityID::id_type);)
+    SERVER_ONLY(std::span<EntityID::id_type const> active_ids() const;)
     uint8_t ent_exists(EntityID const &) const;
     uint8_t ent_alive(EntityID const &) const;
     void pre_tick();
     void tick();
     void post_tick();
 
-    void for_each_entity(std::function<void (Simulation *, Entity &)>);
-    void for_each_pending_delete(std::function<void (Simulation *, Entity &)>);
+    void for_each_entity(FunctionRef<void (Simulation *, Entity &)>);
+    void for_each_pending_delete(FunctionRef<void (Simulation *, Entity &)>);
 
     template <uint8_t>
-    void for_each(std::function<void (Simulation *, Entity &)>);
+    void for_each(FunctionRef<void (Simulation *, Entity &)>);
 };
\ No newline at end of file
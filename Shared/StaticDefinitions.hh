@@ -173,6 +173,14 @@ namespace InputFlags {
     };
 }
 
+//optional trailing byte of kVerify, old clients never send it
+//it can be followed by the largest entity cap the client can hold, as a uint32
+namespace VerifyFlags {
+    enum {
+        kTickTimestamps
+    };
+}
+
 struct PoisonDamage {
     float damage;
     float time;
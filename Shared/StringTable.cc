@@ -0,0 +1,162 @@
+#include <Shared/StringTable.hh>
+
+#include <Shared/Binary.hh>
+#include <Shared/ReservedArray.hh>
+#include <Shared/StaticData.hh>
+
+#include <algorithm>
+#include <cstring>
+#include <string>
+#include <vector>
+
+StringID::StringID(id_type id) : id(id) {}
+
+StringID StringID::mob_name(MobID::T mob_id) {
+    return StringID(mob_id + 1);
+}
+
+bool StringID::null() const {
+    return id == 0;
+}
+
+bool StringID::fixed() const {
+    return id <= MobID::kNumMobs;
+}
+
+bool operator==(StringID const a, StringID const b) {
+    return a.id == b.id;
+}
+
+#ifdef SERVERSIDE
+//player names are cut to MAX_NAME_LENGTH bytes, this leaves room to spare
+static uint32_t const MAX_BYTES = 31;
+static uint32_t const BUCKETS = 1 << 12;
+
+struct Entry {
+    char text[MAX_BYTES + 1];
+    uint8_t length;
+    //on the reclaim list, so it is put there once however often it is dropped and taken up again
+    uint8_t pending;
+    //the next handle in the same bucket, or on the free list
+    StringID::id_type next;
+    uint32_t refs;
+};
+
+//indexed by handle, the fixed handles are never used
+//reserved for every handle, only what has been handed out is committed
+static ReservedArray<Entry> entries;
+static StringID::id_type buckets[BUCKETS] = {0};
+static StringID::id_type free_list = 0;
+//handles past this one have never been handed out
+static uint32_t high_water = MobID::kNumMobs;
+static ReservedArray<StringID::id_type> unreferenced;
+static uint32_t unreferenced_count = 0;
+static uint32_t live = 0;
+
+static uint32_t _bucket(std::string_view str) {
+    uint32_t h = 2166136261u;
+    for (char c : str) h = (h ^ (uint8_t) c) * 16777619u;
+    return h & (BUCKETS - 1);
+}
+
+static void _mark_unreferenced(StringID::id_type id) {
+    Entry &entry = entries[id];
+    if (entry.pending) return;
+    entry.pending = 1;
+    unreferenced[unreferenced_count++] = id;
+}
+
+StringID StringTable::intern(std::string_view str) {
+    if (str.size() == 0) return StringID();
+    if (str.size() > MAX_BYTES) str = str.substr(0, MAX_BYTES);
+    if (entries.capacity() == 0) {
+        entries.reserve(CAPACITY);
+        unreferenced.reserve(CAPACITY);
+        unreferenced.commit(CAPACITY);
+    }
+    uint32_t bucket = _bucket(str);
+    for (StringID::id_type at = buckets[bucket]; at != 0; at = entries[at].next) {
+        Entry const &entry = entries[at];
+        if (entry.length == str.size() && std::memcmp(entry.text, str.data(), str.size()) == 0)
+            return StringID(at);
+    }
+    StringID::id_type id = free_list;
+    if (id != 0) free_list = entries[id].next;
+    else if (high_water + 1 < CAPACITY) {
+        id = ++high_water;
+        if (id >= entries.size()) entries.commit(std::min(std::max(2 * entries.size(), 1024u), CAPACITY));
+    } else return StringID();
+    Entry &entry = entries[id];
+    std::memcpy(entry.text, str.data(), str.size());
+    entry.text[str.size()] = 0;
+    entry.length = str.size();
+    entry.refs = 0;
+    entry.pending = 0;
+    entry.next = buckets[bucket];
+    buckets[bucket] = id;
+    ++live;
+    _mark_unreferenced(id);
+    return StringID(id);
+}
+
+void StringTable::retain(StringID str) {
+    if (str.fixed()) return;
+    ++entries[str.id].refs;
+}
+
+void StringTable::release(StringID str) {
+    if (str.fixed()) return;
+    DEBUG_ONLY(assert(entries[str.id].refs > 0);)
+    if (--entries[str.id].refs == 0) _mark_unreferenced(str.id);
+}
+
+void StringTable::reclaim(FunctionRef<void(StringID)> forget) {
+    for (uint32_t i = 0; i < unreferenced_count; ++i) {
+        StringID::id_type id = unreferenced[i];
+        Entry &entry = entries[id];
+        entry.pending = 0;
+        //stored again since it was dropped
+        if (entry.refs > 0) continue;
+        StringID::id_type *link = &buckets[_bucket(std::string_view(entry.text, entry.length))];
+        while (*link != id) link = &entries[*link].next;
+        *link = entry.next;
+        forget(StringID(id));
+        entry.next = free_list;
+        free_list = id;
+        --live;
+    }
+    unreferenced_count = 0;
+}
+
+uint32_t StringTable::in_use() {
+    return live;
+}
+
+char const *StringTable::get(StringID str) {
+    if (str.null()) return "";
+    if (str.fixed()) return MOB_DATA[str.id - 1].name;
+    return entries[str.id].text;
+}
+
+void StringTable::write(Writer *writer, StringID str) {
+    DEBUG_ONLY(assert(!str.fixed());)
+    Entry const &entry = entries[str.id];
+    writer->write<uint32_t>(entry.length);
+    for (uint32_t i = 0; i < entry.length; ++i) writer->write<uint8_t>(entry.text[i]);
+}
+#else
+//indexed by handle, grown as the server sends handles
+static std::vector<std::string> defined;
+
+char const *StringTable::get(StringID str) {
+    if (str.null()) return "";
+    if (str.fixed()) return MOB_DATA[str.id - 1].name;
+    if (str.id >= defined.size()) return "";
+    return defined[str.id].c_str();
+}
+
+void StringTable::read(Reader *reader, StringID str) {
+    if (str.id >= defined.size()) defined.resize(str.id + 1);
+    reader->read<std::string>(defined[str.id]);
+}
+#endif
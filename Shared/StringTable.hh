@@ -0,0 +1,56 @@
+#pragma once
+
+#include <Shared/Helpers.hh>
+#include <Shared/StaticDefinitions.hh>
+
+#include <cstdint>
+#include <string_view>
+
+SERVER_ONLY(class Writer;)
+CLIENT_ONLY(class Reader;)
+
+//an interned string, what entities and the arena hold in place of a name
+//0 is the empty string and the handles after it are the mob names in MobID order, which every side
+//already has in MOB_DATA, so only the handles past those are ever sent with their string
+class StringID {
+public:
+    typedef uint16_t id_type;
+    id_type id = 0;
+    StringID() = default;
+    explicit StringID(id_type);
+    static StringID mob_name(MobID::T);
+    bool null() const;
+    //a mob name or the empty string, never counted and never sent
+    bool fixed() const;
+};
+
+bool operator==(StringID const, StringID const);
+
+namespace StringTable {
+    //one past the largest handle
+    inline uint32_t const CAPACITY = 1 << (8 * sizeof(StringID::id_type));
+    //the string a handle stands for, "" for one the client hasn't been sent
+    char const *get(StringID);
+#ifdef SERVERSIDE
+    //the handle of an equal string if there is one, otherwise a new handle, which is reclaimed unless
+    //something stores it before the next reclaim()
+    //the null handle if every handle is taken
+    StringID intern(std::string_view);
+    //a handle stored in a field holds a reference, see retain_field
+    void retain(StringID);
+    void release(StringID);
+    //frees the handles nothing has referenced since they were released or interned, after telling
+    //the caller each one, so clients can forget them before they stand for another string
+    void reclaim(FunctionRef<void(StringID)>);
+    uint32_t in_use();
+    //the string behind a handle, how a client learns it
+    void write(Writer *, StringID);
+#else
+    void read(Reader *, StringID);
+#endif
+};
+
+#ifdef SERVERSIDE
+inline void retain_field(StringID const &v) { StringTable::retain(v); }
+inline void release_field(StringID const &v) { StringTable::release(v); }
+#endif